@@ -0,0 +1,34 @@
+#include "allocation_counter.h"
+
+#ifdef NI_COUNT_ALLOCATIONS
+#include <new>
+#include <cstdlib>
+
+// replacements of the global allocation functions that count allocations; they must be defined in exactly one translation unit
+
+void* operator new(std::size_t size)
+{
+	allocation_counter::ref_nr_allocations().fetch_add(1, std::memory_order_relaxed);
+	allocation_counter::ref_nr_bytes().fetch_add(size, std::memory_order_relaxed);
+	if (void* ptr = std::malloc(size ? size : 1))
+		return ptr;
+	throw std::bad_alloc();
+}
+void* operator new[](std::size_t size) { return operator new(size); }
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+	try {
+		return operator new(size);
+	}
+	catch (...) {
+		return nullptr;
+	}
+}
+void* operator new[](std::size_t size, const std::nothrow_t& tag) noexcept { return operator new(size, tag); }
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete[](void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, std::size_t) noexcept { std::free(ptr); }
+void operator delete(void* ptr, const std::nothrow_t&) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept { std::free(ptr); }
+#endif
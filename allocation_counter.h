@@ -0,0 +1,32 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+
+///@ingroup NI
+///@{
+
+/**@file
+   process wide counters of heap allocations, enabled by defining NI_COUNT_ALLOCATIONS which makes allocation_counter.cxx
+   replace the global operator new
+*/
+
+/// counters of heap allocations done through the global operator new
+struct allocation_counter
+{
+	/// number of allocations since program start
+	static std::atomic<size_t>& ref_nr_allocations() { static std::atomic<size_t> nr(0); return nr; }
+	/// number of allocated bytes since program start
+	static std::atomic<size_t>& ref_nr_bytes() { static std::atomic<size_t> nr(0); return nr; }
+	/// return whether the global operator new is replaced by a counting version
+	static bool is_enabled()
+	{
+#ifdef NI_COUNT_ALLOCATIONS
+		return true;
+#else
+		return false;
+#endif
+	}
+};
+
+///@}
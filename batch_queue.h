@@ -0,0 +1,66 @@
+#pragma once
+
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+
+///@ingroup NI
+///@{
+
+/**@file
+   queue that hands items from producing threads to one consumer thread in batches
+*/
+
+/// producers push single items and the consumer takes all pending items at once by swapping vectors, such that the capacity of both
+/// vectors is reused and no heap allocation happens once the batch size is stable
+template <typename T>
+class batch_queue
+{
+protected:
+	std::mutex mutex;
+	std::condition_variable condition;
+	// items pushed since the consumer took the last batch
+	std::vector<T> pending;
+	// whether the consumer is asked to stop
+	bool stopped;
+public:
+	/// construct running queue
+	batch_queue() : stopped(false) {}
+	/// append item and wake the consumer
+	void push(const T& item)
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			pending.push_back(item);
+		}
+		condition.notify_one();
+	}
+	/// wait until items are pending, the timeout elapsed or the queue is stopped, then swap the pending items into the empty batch;
+	/// return false if the queue is stopped
+	bool wait_and_take(std::vector<T>& batch, std::chrono::milliseconds timeout)
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		condition.wait_for(lock, timeout, [this]() { return stopped || !pending.empty(); });
+		batch.swap(pending);
+		return !stopped;
+	}
+	/// ask the consumer to stop
+	void stop()
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			stopped = true;
+		}
+		condition.notify_all();
+	}
+	/// accept items again after stop and drop items that were not taken
+	void restart()
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopped = false;
+		pending.clear();
+	}
+};
+
+///@}
@@ -0,0 +1,124 @@
+#pragma once
+
+#include <cgv/render/render_types.h>
+#include <vector>
+#include <cmath>
+#include <algorithm>
+
+///@ingroup NI
+///@{
+
+/**@file
+   uniform grid over the xz-plane that accelerates vertical ray casts against axis aligned boxes
+*/
+
+/// each grid column stores the indices of all boxes whose xz-footprint overlaps the column
+class column_grid : public cgv::render::render_types
+{
+protected:
+	// xz-coordinates of the lower left corner of the grid
+	vec2 origin;
+	// side length of a column
+	float cell_size;
+	// number of columns along x and z
+	int res_x, res_z;
+	// per column offset into cell_items, with one additional entry marking the end
+	std::vector<unsigned> cell_start;
+	// box indices of all columns stored one column after the other
+	std::vector<unsigned> cell_items;
+	/// compute the column coordinates of an xz-position and clamp them to the grid
+	void locate(float x, float z, int& i, int& j) const
+	{
+		i = std::max(0, std::min(res_x - 1, (int)std::floor((x - origin[0]) / cell_size)));
+		j = std::max(0, std::min(res_z - 1, (int)std::floor((z - origin[1]) / cell_size)));
+	}
+public:
+	/// construct empty grid
+	column_grid() : origin(0.0f, 0.0f), cell_size(1.0f), res_x(0), res_z(0) {}
+	/// return whether the grid has been built
+	bool empty() const { return cell_items.empty(); }
+	/// build grid over the given boxes with the given column size, where box_array is any random access container of boxes
+	template <typename box_array>
+	void build(const box_array& boxes, float _cell_size)
+	{
+		cell_size = _cell_size;
+		cell_start.clear();
+		cell_items.clear();
+		res_x = res_z = 0;
+		if (boxes.empty())
+			return;
+		box3 bounds;
+		for (size_t bi = 0; bi < boxes.size(); ++bi) {
+			const box3 b = boxes[bi];
+			bounds.add_point(b.get_min_pnt());
+			bounds.add_point(b.get_max_pnt());
+		}
+		origin = vec2(bounds.get_min_pnt()[0], bounds.get_min_pnt()[2]);
+		res_x = std::max(1, (int)std::ceil(bounds.get_extent()[0] / cell_size));
+		res_z = std::max(1, (int)std::ceil(bounds.get_extent()[2] / cell_size));
+		// count boxes per column first and fill in a second pass to get a compact layout
+		cell_start.assign(size_t(res_x) * res_z + 1, 0);
+		for (int pass = 0; pass < 2; ++pass) {
+			for (unsigned bi = 0; bi < boxes.size(); ++bi) {
+				// boxes are not guaranteed to have ordered min and max points
+				const box3 b = boxes[bi];
+				const vec3& p0 = b.get_min_pnt();
+				const vec3& p1 = b.get_max_pnt();
+				int i0, j0, i1, j1;
+				locate(std::min(p0[0], p1[0]), std::min(p0[2], p1[2]), i0, j0);
+				locate(std::max(p0[0], p1[0]), std::max(p0[2], p1[2]), i1, j1);
+				for (int j = j0; j <= j1; ++j)
+					for (int i = i0; i <= i1; ++i) {
+						size_t ci = size_t(j) * res_x + i;
+						if (pass == 0)
+							++cell_start[ci + 1];
+						else
+							cell_items[cell_start[ci]++] = bi;
+					}
+			}
+			if (pass == 0) {
+				for (size_t ci = 1; ci < cell_start.size(); ++ci)
+					cell_start[ci] += cell_start[ci - 1];
+				cell_items.resize(cell_start.back());
+			}
+			else {
+				// filling advanced each start offset to the start of the next column
+				for (size_t ci = cell_start.size() - 1; ci > 0; --ci)
+					cell_start[ci] = cell_start[ci - 1];
+				cell_start[0] = 0;
+			}
+		}
+	}
+	/// cast a ray from p straight down and return the index of the box with the highest top face below p or -1 if no box is hit; y_hit receives the height of the top face
+	template <typename box_array>
+	int cast_down(const box_array& boxes, const vec3& p, float& y_hit) const
+	{
+		if (cell_items.empty())
+			return -1;
+		if (p[0] < origin[0] || p[2] < origin[1] ||
+			p[0] > origin[0] + res_x * cell_size || p[2] > origin[1] + res_z * cell_size)
+			return -1;
+		int i, j;
+		locate(p[0], p[2], i, j);
+		size_t ci = size_t(j) * res_x + i;
+		int result = -1;
+		for (unsigned k = cell_start[ci]; k < cell_start[ci + 1]; ++k) {
+			const box3 b = boxes[cell_items[k]];
+			const vec3& p0 = b.get_min_pnt();
+			const vec3& p1 = b.get_max_pnt();
+			if (p[0] < std::min(p0[0], p1[0]) || p[0] > std::max(p0[0], p1[0]) ||
+				p[2] < std::min(p0[2], p1[2]) || p[2] > std::max(p0[2], p1[2]))
+				continue;
+			float y_top = std::max(p0[1], p1[1]);
+			if (y_top > p[1])
+				continue;
+			if (result == -1 || y_top > y_hit) {
+				result = (int)cell_items[k];
+				y_hit = y_top;
+			}
+		}
+		return result;
+	}
+};
+
+///@}
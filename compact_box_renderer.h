@@ -0,0 +1,162 @@
+#pragma once
+
+#include <cgv/render/context.h>
+#include <cgv/render/shader_program.h>
+#include <cgv_gl/gl/gl.h>
+#include <cstddef>
+#include "compact_boxes.h"
+
+///@ingroup NI
+///@{
+
+/**@file
+   renderer that draws compact boxes from their quantized gpu copy
+*/
+
+/// uploads quantized centers, half float extents, 8 bit colors and optionally compact transforms as raw vertex attributes
+/// and decodes them in the compact_box shader program, such that a box takes 15 instead of 36 bytes on the gpu
+class compact_box_renderer : public cgv::render::render_types
+{
+protected:
+	// program decoding the attributes and expanding each box to its visible faces
+	cgv::render::shader_program prog;
+	// vertex array with the attribute layout and buffers for boxes, colors and transforms
+	GLuint vao, box_buffer, color_buffer, transform_buffer;
+	// number of transforms the transform buffer can hold
+	size_t transform_capacity;
+	// chunks of the uploaded boxes, each drawn with its own origin
+	std::vector<compact_box_array::chunk> chunks;
+	// side length of a chunk
+	float chunk_size;
+	// number of uploaded boxes
+	size_t nr_boxes;
+	// whether transforms have been uploaded
+	bool has_transforms;
+	// cube in which translations of the transforms are quantized
+	vec3 region_min;
+	float region_size;
+public:
+	/// construct renderer without gpu objects
+	compact_box_renderer() : vao(0), box_buffer(0), color_buffer(0), transform_buffer(0), transform_capacity(0),
+		chunk_size(1.0f), nr_boxes(0), has_transforms(false), region_min(0.0f), region_size(1.0f) {}
+	/// build the program and set up the attribute layout, return false if the program is not available in which case boxes have to be decoded for drawing
+	bool init(cgv::render::context& ctx)
+	{
+		if (!prog.build_program(ctx, "compact_box.glpr", true))
+			return false;
+		glGenVertexArrays(1, &vao);
+		glGenBuffers(1, &box_buffer);
+		glGenBuffers(1, &color_buffer);
+		glGenBuffers(1, &transform_buffer);
+		glBindVertexArray(vao);
+		typedef compact_box_array::box box;
+		glBindBuffer(GL_ARRAY_BUFFER, box_buffer);
+		glVertexAttribPointer(0, 3, GL_UNSIGNED_SHORT, GL_TRUE, sizeof(box), (const void*)offsetof(box, center));
+		glVertexAttribPointer(1, 3, GL_HALF_FLOAT, GL_FALSE, sizeof(box), (const void*)offsetof(box, extent));
+		glEnableVertexAttribArray(0);
+		glEnableVertexAttribArray(1);
+		glBindBuffer(GL_ARRAY_BUFFER, color_buffer);
+		glVertexAttribPointer(2, 3, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(rgb8), 0);
+		glEnableVertexAttribArray(2);
+		// transform attributes are enabled once transforms are uploaded
+		glBindBuffer(GL_ARRAY_BUFFER, transform_buffer);
+		glVertexAttribPointer(3, 3, GL_UNSIGNED_SHORT, GL_TRUE, sizeof(compact_transform), (const void*)offsetof(compact_transform, translation));
+		glVertexAttribIPointer(4, 1, GL_UNSIGNED_INT, sizeof(compact_transform), (const void*)offsetof(compact_transform, rotation));
+		glBindVertexArray(0);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		return true;
+	}
+	/// check whether init succeeded
+	bool is_initialized() const { return vao != 0; }
+	/// destruct program and gpu objects
+	void clear(cgv::render::context& ctx)
+	{
+		if (prog.is_created())
+			prog.destruct(ctx);
+		if (vao == 0)
+			return;
+		GLuint buffers[3] = { box_buffer, color_buffer, transform_buffer };
+		glDeleteBuffers(3, buffers);
+		glDeleteVertexArrays(1, &vao);
+		vao = box_buffer = color_buffer = transform_buffer = 0;
+		transform_capacity = 0;
+		nr_boxes = 0;
+		has_transforms = false;
+	}
+	/// upload the quantized boxes and colors without decoding them
+	void set_boxes(const compact_box_array& A)
+	{
+		chunks = A.get_chunks();
+		chunk_size = A.get_chunk_size();
+		nr_boxes = A.size();
+		glBindBuffer(GL_ARRAY_BUFFER, box_buffer);
+		glBufferData(GL_ARRAY_BUFFER, A.get_boxes().size() * sizeof(compact_box_array::box), A.get_boxes().data(), GL_STATIC_DRAW);
+		glBindBuffer(GL_ARRAY_BUFFER, color_buffer);
+		glBufferData(GL_ARRAY_BUFFER, A.get_colors().size() * sizeof(rgb8), A.get_colors().data(), GL_STATIC_DRAW);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+	}
+	/// replace the color of the i-th uploaded box
+	void replace_color(size_t i, const rgb8& c)
+	{
+		glBindBuffer(GL_ARRAY_BUFFER, color_buffer);
+		glBufferSubData(GL_ARRAY_BUFFER, i * sizeof(rgb8), sizeof(rgb8), &c);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+	}
+	/// upload one transform per box in the order of the uploaded boxes, translations are quantized in the cube of side length _region_size at _region_min
+	void set_transforms(const std::vector<compact_transform>& transforms, const vec3& _region_min, float _region_size)
+	{
+		region_min = _region_min;
+		region_size = _region_size;
+		glBindBuffer(GL_ARRAY_BUFFER, transform_buffer);
+		// the buffer storage is reused as long as the number of boxes does not grow
+		if (transforms.size() > transform_capacity) {
+			glBufferData(GL_ARRAY_BUFFER, transforms.size() * sizeof(compact_transform), transforms.data(), GL_STREAM_DRAW);
+			transform_capacity = transforms.size();
+		}
+		else
+			glBufferSubData(GL_ARRAY_BUFFER, 0, transforms.size() * sizeof(compact_transform), transforms.data());
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		if (!has_transforms) {
+			glBindVertexArray(vao);
+			glEnableVertexAttribArray(3);
+			glEnableVertexAttribArray(4);
+			glBindVertexArray(0);
+			has_transforms = true;
+		}
+	}
+	/// draw all boxes with one draw call per chunk
+	void draw(cgv::render::context& ctx)
+	{
+		if (nr_boxes == 0 || !prog.enable(ctx))
+			return;
+		// matrices of the context are double precision while the program expects float
+		auto MV = ctx.get_modelview_matrix();
+		auto P = ctx.get_projection_matrix();
+		mat4 modelview, projection;
+		for (unsigned i = 0; i < 4; ++i)
+			for (unsigned j = 0; j < 4; ++j) {
+				modelview(i, j) = (float)MV(i, j);
+				projection(i, j) = (float)P(i, j);
+			}
+		prog.set_uniform(ctx, "modelview_matrix", modelview);
+		prog.set_uniform(ctx, "projection_matrix", projection);
+		prog.set_uniform(ctx, "chunk_size", chunk_size);
+		prog.set_uniform(ctx, "use_transforms", has_transforms);
+		prog.set_uniform(ctx, "region_min", region_min);
+		prog.set_uniform(ctx, "region_size", region_size);
+		glBindVertexArray(vao);
+		for (const auto& c : chunks) {
+			prog.set_uniform(ctx, "chunk_origin", c.origin);
+			glDrawArrays(GL_POINTS, c.begin, c.end - c.begin);
+		}
+		glBindVertexArray(0);
+		prog.disable(ctx);
+	}
+	/// return the number of bytes uploaded to the gpu
+	size_t get_nr_gpu_bytes() const
+	{
+		return nr_boxes * (sizeof(compact_box_array::box) + sizeof(rgb8)) + transform_capacity * sizeof(compact_transform);
+	}
+};
+
+///@}
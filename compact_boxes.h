@@ -0,0 +1,285 @@
+#pragma once
+
+#include <cgv/render/render_types.h>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include <cmath>
+#include <algorithm>
+
+///@ingroup NI
+///@{
+
+/**@file
+   quantized storage of boxes and rigid transforms for very large scenes
+*/
+
+/// convert float to 16 bit half float with rounding to nearest, where ties are rounded away from zero
+inline uint16_t float_to_half(float f)
+{
+	uint32_t x;
+	std::memcpy(&x, &f, 4);
+	uint32_t sign = (x >> 16) & 0x8000;
+	int32_t exp = int32_t((x >> 23) & 0xff) - 127 + 15;
+	uint32_t mant = x & 0x7fffff;
+	// infinity and nan
+	if (((x >> 23) & 0xff) == 0xff)
+		return uint16_t(sign | 0x7c00 | (mant ? 0x200 : 0));
+	// overflow
+	if (exp >= 31)
+		return uint16_t(sign | 0x7c00);
+	// subnormal or underflow
+	if (exp <= 0) {
+		if (exp < -10)
+			return uint16_t(sign);
+		mant |= 0x800000;
+		uint32_t shift = uint32_t(14 - exp);
+		uint32_t h = mant >> shift;
+		if ((mant >> (shift - 1)) & 1)
+			++h;
+		return uint16_t(sign | h);
+	}
+	uint32_t h = sign | (uint32_t(exp) << 10) | (mant >> 13);
+	// a carry out of the mantissa correctly increments the exponent
+	if (mant & 0x1000)
+		++h;
+	return uint16_t(h);
+}
+
+/// convert 16 bit half float to float
+inline float half_to_float(uint16_t h)
+{
+	uint32_t sign = uint32_t(h & 0x8000) << 16;
+	uint32_t exp = (h >> 10) & 0x1f;
+	uint32_t mant = h & 0x3ff;
+	uint32_t x;
+	if (exp == 0) {
+		if (mant == 0)
+			x = sign;
+		else {
+			// renormalize subnormal
+			exp = 127 - 15 + 1;
+			while ((mant & 0x400) == 0) {
+				mant <<= 1;
+				--exp;
+			}
+			mant &= 0x3ff;
+			x = sign | (exp << 23) | (mant << 13);
+		}
+	}
+	else if (exp == 31)
+		x = sign | 0x7f800000 | (mant << 13);
+	else
+		x = sign | ((exp + 127 - 15) << 23) | (mant << 13);
+	float f;
+	std::memcpy(&f, &x, 4);
+	return f;
+}
+
+/// pack unit quaternion into 32 bits by storing the index of the largest component and the other three with 10 bits each
+template <typename Q>
+uint32_t pack_quaternion(const Q& q)
+{
+	const float s = 1.41421356f;
+	unsigned m = 0;
+	for (unsigned i = 1; i < 4; ++i)
+		if (std::abs(q[i]) > std::abs(q[m]))
+			m = i;
+	// q and -q represent the same rotation, so make the dropped component positive
+	float sign = q[m] < 0 ? -1.0f : 1.0f;
+	uint32_t packed = uint32_t(m) << 30;
+	unsigned shift = 20;
+	for (unsigned i = 0; i < 4; ++i) {
+		if (i == m)
+			continue;
+		float v = std::max(-1.0f, std::min(1.0f, sign * q[i] * s));
+		packed |= uint32_t(std::lround((v + 1.0f) * 0.5f * 1023.0f)) << shift;
+		shift -= 10;
+	}
+	return packed;
+}
+
+/// unpack quaternion packed with pack_quaternion
+template <typename Q>
+Q unpack_quaternion(uint32_t packed)
+{
+	const float s = 0.70710678f;
+	Q q;
+	unsigned m = packed >> 30;
+	unsigned shift = 20;
+	float sum = 0;
+	for (unsigned i = 0; i < 4; ++i) {
+		if (i == m)
+			continue;
+		float v = (((packed >> shift) & 1023) / 1023.0f * 2.0f - 1.0f) * s;
+		q[i] = v;
+		sum += v * v;
+		shift -= 10;
+	}
+	q[m] = std::sqrt(std::max(0.0f, 1.0f - sum));
+	return q;
+}
+
+/// boxes stored with 16 bit centers relative to the origin of their chunk, half float extents and 8 bit colors
+class compact_box_array : public cgv::render::render_types
+{
+public:
+	/// quantized box
+	struct box
+	{
+		uint16_t center[3];
+		uint16_t extent[3];
+	};
+	/// a chunk is a cube of side length chunk_size whose boxes are stored contiguously
+	struct chunk
+	{
+		vec3 origin;
+		unsigned begin, end;
+	};
+protected:
+	// side length of a chunk
+	float chunk_size;
+	// chunks ordered by their first box
+	std::vector<chunk> chunks;
+	// quantized boxes ordered by chunk
+	std::vector<box> boxes;
+	// colors in the order of the boxes
+	std::vector<rgb8> colors;
+	/// decode box i of chunk c
+	box3 decode(const chunk& c, const box& b) const
+	{
+		const float scale = chunk_size / 65535.0f;
+		vec3 center, extent;
+		for (int j = 0; j < 3; ++j) {
+			center[j] = c.origin[j] + scale * b.center[j];
+			extent[j] = half_to_float(b.extent[j]);
+		}
+		return box3(center - 0.5f * extent, center + 0.5f * extent);
+	}
+public:
+	/// construct empty array
+	compact_box_array() : chunk_size(16.0f) {}
+	/// return number of stored boxes
+	size_t size() const { return boxes.size(); }
+	/// return whether no boxes are stored
+	bool empty() const { return boxes.empty(); }
+	/// release all storage
+	void clear()
+	{
+		std::vector<chunk>().swap(chunks);
+		std::vector<box>().swap(boxes);
+		std::vector<rgb8>().swap(colors);
+	}
+	/// quantize color to 8 bits per component
+	static rgb8 quantize_color(const rgb& C)
+	{
+		return rgb8(
+			(uint8_t)std::lround(255 * std::max(0.0f, std::min(1.0f, C[0]))),
+			(uint8_t)std::lround(255 * std::max(0.0f, std::min(1.0f, C[1]))),
+			(uint8_t)std::lround(255 * std::max(0.0f, std::min(1.0f, C[2]))));
+	}
+	/// encode n boxes and colors, the box order is changed to group boxes by chunk; if given, order receives the index of the source box of each stored box
+	void build(const box3* float_boxes, const rgb* float_colors, size_t n, float _chunk_size, std::vector<unsigned>* order = 0)
+	{
+		clear();
+		chunk_size = _chunk_size;
+		// determine chunk of each box from the cell containing its center
+		struct entry { int i, j, k; unsigned bi; };
+		std::vector<entry> entries(n);
+		for (unsigned bi = 0; bi < n; ++bi) {
+			vec3 c = float_boxes[bi].get_center();
+			entries[bi] = { (int)std::floor(c[0] / chunk_size), (int)std::floor(c[1] / chunk_size), (int)std::floor(c[2] / chunk_size), bi };
+		}
+		std::sort(entries.begin(), entries.end(), [](const entry& a, const entry& b) {
+			return a.k != b.k ? a.k < b.k : (a.j != b.j ? a.j < b.j : (a.i != b.i ? a.i < b.i : a.bi < b.bi));
+		});
+		boxes.resize(entries.size());
+		colors.resize(entries.size());
+		const float scale = 65535.0f / chunk_size;
+		for (unsigned e = 0; e < entries.size(); ++e) {
+			const entry& E = entries[e];
+			if (e == 0 || E.i != entries[e - 1].i || E.j != entries[e - 1].j || E.k != entries[e - 1].k) {
+				if (!chunks.empty())
+					chunks.back().end = e;
+				chunks.push_back({ vec3(E.i * chunk_size, E.j * chunk_size, E.k * chunk_size), e, e });
+			}
+			const box3& B = float_boxes[E.bi];
+			vec3 center = B.get_center() - chunks.back().origin;
+			vec3 extent = B.get_extent();
+			for (int j = 0; j < 3; ++j) {
+				boxes[e].center[j] = uint16_t(std::max(0.0f, std::min(65535.0f, std::round(scale * center[j]))));
+				// store absolute extents as boxes do not always have ordered corners
+				boxes[e].extent[j] = float_to_half(std::abs(extent[j]));
+			}
+			colors[e] = quantize_color(float_colors[E.bi]);
+		}
+		if (!chunks.empty())
+			chunks.back().end = (unsigned)entries.size();
+		if (order) {
+			order->resize(entries.size());
+			for (unsigned e = 0; e < entries.size(); ++e)
+				(*order)[e] = entries[e].bi;
+		}
+	}
+	/// decode the i-th box
+	box3 operator[](size_t i) const
+	{
+		auto iter = std::upper_bound(chunks.begin(), chunks.end(), (unsigned)i, [](unsigned i, const chunk& c) { return i < c.begin; });
+		return decode(*(iter - 1), boxes[i]);
+	}
+	/// decode all boxes and append them to the given vector
+	void decode_boxes(std::vector<box3>& float_boxes) const
+	{
+		size_t offset = float_boxes.size();
+		float_boxes.resize(offset + boxes.size());
+		for (const chunk& c : chunks)
+			for (unsigned i = c.begin; i < c.end; ++i)
+				float_boxes[offset + i] = decode(c, boxes[i]);
+	}
+	/// access the 8 bit colors in the order of the boxes
+	const std::vector<rgb8>& get_colors() const { return colors; }
+	/// access the quantized boxes ordered by chunk
+	const std::vector<box>& get_boxes() const { return boxes; }
+	/// access the chunks ordered by their first box
+	const std::vector<chunk>& get_chunks() const { return chunks; }
+	/// return the side length of a chunk
+	float get_chunk_size() const { return chunk_size; }
+	/// return the number of chunks
+	size_t get_nr_chunks() const { return chunks.size(); }
+	/// return the number of bytes used by the compact representation
+	size_t get_nr_bytes() const
+	{
+		return chunks.size() * sizeof(chunk) + boxes.size() * sizeof(box) + colors.size() * sizeof(rgb8);
+	}
+};
+
+/// rigid transform with translation quantized to 16 bits per component inside a given region and a smallest-three packed rotation
+struct compact_transform
+{
+	uint16_t translation[3];
+	uint32_t rotation;
+};
+
+/// quantize translation t relative to the cube of side length region_size at region_min and pack rotation q
+template <typename V, typename Q>
+compact_transform pack_transform(const V& t, const Q& q, const V& region_min, float region_size)
+{
+	compact_transform ct;
+	const float scale = 65535.0f / region_size;
+	for (int j = 0; j < 3; ++j)
+		ct.translation[j] = uint16_t(std::max(0.0f, std::min(65535.0f, std::round(scale * (t[j] - region_min[j])))));
+	ct.rotation = pack_quaternion(q);
+	return ct;
+}
+
+/// decode transform packed with pack_transform
+template <typename V, typename Q>
+void unpack_transform(const compact_transform& ct, const V& region_min, float region_size, V& t, Q& q)
+{
+	const float scale = region_size / 65535.0f;
+	for (int j = 0; j < 3; ++j)
+		t[j] = region_min[j] + scale * ct.translation[j];
+	q = unpack_quaternion<Q>(ct.rotation);
+}
+
+///@}
@@ -0,0 +1,141 @@
+#pragma once
+
+#include "intersection.h"
+#include <cgv/render/render_types.h>
+#include <cmath>
+#include <algorithm>
+
+///@ingroup NI
+///@{
+
+/**@file
+   tolerant picking of oriented boxes with a cone around the pointer ray
+*/
+
+/// tests oriented boxes against a cone that is sampled by a coherent packet of rays, each box is first rejected against the analytic cone such that most boxes cost less than a single ray
+class cone_picker : public cgv::render::render_types
+{
+public:
+	/// number of rays in a packet: the axis, an inner ring of 5 and an outer ring of 10 rays
+	static const unsigned packet_size = 16;
+protected:
+	// apex and unit axis of the cone
+	vec3 origin, axis;
+	// half opening angle in radians
+	float half_angle;
+	// ray directions of the packet and their angles to the axis
+	vec3 directions[packet_size];
+	float angles[packet_size];
+	/// return distance of p to box B and the closest point q of the box
+	static float get_box_distance(const box3& B, const vec3& p, vec3& q)
+	{
+		for (int j = 0; j < 3; ++j)
+			q[j] = std::max(B.get_min_pnt()[j], std::min(B.get_max_pnt()[j], p[j]));
+		return (q - p).length();
+	}
+public:
+	/// construct cone along the z-axis
+	cone_picker() { set_cone(vec3(0.0f), vec3(0, 0, 1), 0.01f); }
+	/// set apex, axis and half opening angle of the cone and build the ray packet
+	void set_cone(const vec3& _origin, const vec3& _axis, float _half_angle)
+	{
+		origin = _origin;
+		axis = normalize(_axis);
+		half_angle = _half_angle;
+		// orthonormal basis perpendicular to the axis
+		vec3 u = cross(axis, std::abs(axis[0]) < 0.9f ? vec3(1, 0, 0) : vec3(0, 1, 0));
+		u.normalize();
+		vec3 v = cross(axis, u);
+		directions[0] = axis;
+		angles[0] = 0;
+		for (unsigned k = 1; k < packet_size; ++k) {
+			bool inner = k < 6;
+			float angle = inner ? 0.5f * half_angle : half_angle;
+			float phi = inner ? 2.0f * 3.14159265f * (k - 1) / 5 : 2.0f * 3.14159265f * ((k - 6) + 0.5f) / 10;
+			directions[k] = std::cos(angle) * axis + std::sin(angle) * (std::cos(phi) * u + std::sin(phi) * v);
+			angles[k] = angle;
+		}
+	}
+	/// test box B transformed by rotation and translation; on success score receives a value in which angular distance from the axis in units of the half angle is added to depth_weight times the hit distance, and point receives the picked world location
+	bool test_box(const box3& B, const vec3& translation, const quat& rotation, float depth_weight, float& score, vec3& point) const
+	{
+		// reject with the bounding sphere against the analytic cone
+		vec3 center = translation + rotation.apply(B.get_center());
+		float radius = 0.5f * B.get_extent().length();
+		vec3 w = center - origin;
+		float dist = w.length();
+		bool inside_sphere = dist <= radius;
+		float center_angle = 0, sphere_angle = 0;
+		if (!inside_sphere) {
+			center_angle = std::acos(std::max(-1.0f, std::min(1.0f, dot(w, axis) / dist)));
+			sphere_angle = std::asin(radius / dist);
+			if (center_angle - sphere_angle > half_angle)
+				return false;
+		}
+		// transform the shared origin once and the packet by the rows of the inverse rotation
+		vec3 local_origin = origin - translation;
+		rotation.inverse_rotate(local_origin);
+		vec3 rx = rotation.apply(vec3(1, 0, 0));
+		vec3 ry = rotation.apply(vec3(0, 1, 0));
+		vec3 rz = rotation.apply(vec3(0, 0, 1));
+		bool found = false;
+		for (unsigned k = 0; k < packet_size; ++k) {
+			// rays are ordered by increasing angle, so once the angle alone exceeds the best score no later ray can win
+			if (found && angles[k] / half_angle >= score)
+				break;
+			const vec3& d = directions[k];
+			vec3 local_direction(dot(d, rx), dot(d, ry), dot(d, rz));
+			float t;
+			vec3 p, n;
+			if (!cgv::media::ray_axis_aligned_box_intersection(local_origin, local_direction, B, t, p, n, 0.000001f))
+				continue;
+			float s = angles[k] / half_angle + depth_weight * t;
+			if (!found || s < score) {
+				score = s;
+				point = origin + t * d;
+				found = true;
+			}
+		}
+		if (found)
+			return true;
+		// Boxes can fall between the rays of the packet. The cone is the union of the balls around the axis points at parameter t with
+		// radius t sin(half_angle), so it meets the box iff the convex function dist(axis point, box) - t sin(half_angle) is not positive
+		// somewhere. Its minimum is found by golden section search over the parameters at which the bounding sphere can be reached.
+		vec3 local_axis(dot(axis, rx), dot(axis, ry), dot(axis, rz));
+		float sin_half_angle = std::sin(half_angle);
+		float t0 = std::max(0.0f, (dist - radius) * std::cos(half_angle)), t1 = dist + radius;
+		const float g = 0.618034f;
+		float ta = t1 - g * (t1 - t0), tb = t0 + g * (t1 - t0);
+		vec3 q;
+		float fa = get_box_distance(B, local_origin + ta * local_axis, q) - ta * sin_half_angle;
+		float fb = get_box_distance(B, local_origin + tb * local_axis, q) - tb * sin_half_angle;
+		for (unsigned i = 0; i < 32; ++i) {
+			if (fa < fb) {
+				t1 = tb;
+				tb = ta;
+				fb = fa;
+				ta = t1 - g * (t1 - t0);
+				fa = get_box_distance(B, local_origin + ta * local_axis, q) - ta * sin_half_angle;
+			}
+			else {
+				t0 = ta;
+				ta = tb;
+				fa = fb;
+				tb = t0 + g * (t1 - t0);
+				fb = get_box_distance(B, local_origin + tb * local_axis, q) - tb * sin_half_angle;
+			}
+		}
+		float t = 0.5f * (t0 + t1);
+		if (get_box_distance(B, local_origin + t * local_axis, q) > t * sin_half_angle)
+			return false;
+		// pick the box point closest to the axis point, which lies inside the cone
+		point = translation + rotation.apply(q);
+		vec3 v = point - origin;
+		float along = dot(v, axis);
+		float angle = std::atan2((v - along * axis).length(), along);
+		score = std::min(angle / half_angle, 1.0f) + depth_weight * v.length();
+		return true;
+	}
+};
+
+///@}
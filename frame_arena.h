@@ -0,0 +1,91 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <cstddef>
+#include <algorithm>
+
+///@ingroup NI
+///@{
+
+/**@file
+   bump allocation of temporary arrays that live no longer than a frame
+*/
+
+/// bump allocator that hands out memory from one buffer and is reset at the start of each frame; requests that do not fit are served from overflow blocks and the buffer grows to the peak usage on the next reset, such that no heap allocation happens once the frame working set is stable
+class frame_arena
+{
+protected:
+	// main buffer
+	std::unique_ptr<char[]> buffer;
+	size_t capacity;
+	// bytes handed out since the last reset including overflow
+	size_t used;
+	// maximum of used over all frames
+	size_t peak;
+	// blocks allocated when the buffer was exhausted, released on reset
+	std::vector<std::unique_ptr<char[]> > overflow;
+public:
+	/// construct arena with an initial capacity in bytes
+	frame_arena(size_t initial_capacity = 4096) : buffer(new char[initial_capacity]), capacity(initial_capacity), used(0), peak(0) {}
+	/// return memory for size bytes with the given alignment
+	void* allocate(size_t size, size_t alignment)
+	{
+		size_t offset = (used + alignment - 1) / alignment * alignment;
+		used = offset + size;
+		peak = std::max(peak, used);
+		if (used <= capacity)
+			return buffer.get() + offset;
+		overflow.push_back(std::unique_ptr<char[]>(new char[size + alignment]));
+		size_t address = reinterpret_cast<size_t>(overflow.back().get());
+		return overflow.back().get() + ((address + alignment - 1) / alignment * alignment - address);
+	}
+	/// invalidate all memory handed out so far and grow the buffer if the last frame did not fit
+	void reset()
+	{
+		if (!overflow.empty()) {
+			overflow.clear();
+			size_t new_capacity = capacity;
+			while (new_capacity < peak)
+				new_capacity *= 2;
+			buffer.reset(new char[new_capacity]);
+			capacity = new_capacity;
+		}
+		used = 0;
+	}
+	/// return bytes handed out since the last reset
+	size_t get_used() const { return used; }
+	/// return maximum number of bytes handed out between two resets
+	size_t get_peak() const { return peak; }
+	/// return size of the main buffer
+	size_t get_capacity() const { return capacity; }
+};
+
+/// standard conforming allocator drawing from a frame_arena, deallocation is a no-op
+template <typename T>
+class arena_allocator
+{
+public:
+	typedef T value_type;
+	frame_arena* arena;
+	/// construct allocator for the given arena
+	arena_allocator(frame_arena& _arena) : arena(&_arena) {}
+	/// convert from allocator of other type
+	template <typename U>
+	arena_allocator(const arena_allocator<U>& other) : arena(other.arena) {}
+	/// allocate n elements
+	T* allocate(size_t n) { return static_cast<T*>(arena->allocate(n * sizeof(T), alignof(T))); }
+	/// memory is reclaimed by resetting the arena
+	void deallocate(T*, size_t) {}
+};
+
+template <typename T, typename U>
+bool operator == (const arena_allocator<T>& a, const arena_allocator<U>& b) { return a.arena == b.arena; }
+template <typename T, typename U>
+bool operator != (const arena_allocator<T>& a, const arena_allocator<U>& b) { return a.arena != b.arena; }
+
+/// vector allocating from a frame_arena, must not outlive the next reset of the arena
+template <typename T>
+using arena_vector = std::vector<T, arena_allocator<T> >;
+
+///@}
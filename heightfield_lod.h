@@ -0,0 +1,187 @@
+#pragma once
+
+#include <cgv/render/render_types.h>
+#include <vector>
+#include <map>
+#include <cmath>
+#include <algorithm>
+#include <limits>
+
+///@ingroup NI
+///@{
+
+/**@file
+   far field level of detail for heightfields of boxes
+*/
+
+/// groups boxes standing on the xz-plane into square blocks and replaces each block by a single box of the mean height when it is far from the viewer;
+/// blocks overlapping the xz-footprint of a hole are split into up to four boxes around it
+class heightfield_lod : public cgv::render::render_types
+{
+protected:
+	/// block of fine boxes
+	struct block
+	{
+		// bounds of the fine boxes used for distance computation
+		box3 bounds;
+		// range of fine boxes in the arrays passed to build
+		unsigned begin, end;
+		// range of coarse boxes
+		unsigned coarse_begin, coarse_end;
+	};
+	// blocks in the order of the fine and the coarse boxes
+	std::vector<block> blocks;
+	// one box per block or per piece of a block around the hole
+	std::vector<box3> coarse_boxes;
+	std::vector<rgb> coarse_colors;
+	/// append the coarse box of all fine boxes in the xz-rectangle r0,r1 with the height that preserves their volume inside the rectangle
+	void add_coarse_box(const box3* boxes, const std::vector<unsigned>& box_indices, const vec2& r0, const vec2& r1, const rgb& color)
+	{
+		if (r0[0] >= r1[0] || r0[1] >= r1[1])
+			return;
+		// footprint covered by the fine boxes clipped to the rectangle
+		vec2 c0(std::numeric_limits<float>::max()), c1(-std::numeric_limits<float>::max());
+		float y0 = std::numeric_limits<float>::max(), volume_sum = 0;
+		for (unsigned bi : box_indices) {
+			const box3& B = boxes[bi];
+			float x0 = std::max(B.get_min_pnt()[0], r0[0]), x1 = std::min(B.get_max_pnt()[0], r1[0]);
+			float z0 = std::max(B.get_min_pnt()[2], r0[1]), z1 = std::min(B.get_max_pnt()[2], r1[1]);
+			if (x0 >= x1 || z0 >= z1)
+				continue;
+			c0 = vec2(std::min(c0[0], x0), std::min(c0[1], z0));
+			c1 = vec2(std::max(c1[0], x1), std::max(c1[1], z1));
+			y0 = std::min(y0, B.get_min_pnt()[1]);
+			volume_sum += (x1 - x0) * (z1 - z0) * std::abs(B.get_extent()[1]);
+		}
+		if (volume_sum <= 0)
+			return;
+		float height = volume_sum / ((c1[0] - c0[0]) * (c1[1] - c0[1]));
+		coarse_boxes.push_back(box3(vec3(c0[0], y0, c0[1]), vec3(c1[0], y0 + height, c1[1])));
+		coarse_colors.push_back(color);
+	}
+public:
+	/// contiguous range of boxes
+	struct range
+	{
+		unsigned first, count;
+	};
+	/// build blocks of side length block_size from n boxes and reorder boxes and colors in place such that the fine boxes of each
+	/// block form a contiguous range, which lets the caller draw blocks from a single buffer; coarse boxes never cover the xz-footprint of hole if given
+	void build(box3* boxes, rgb* colors, size_t n, float block_size, const box3* hole = 0)
+	{
+		blocks.clear();
+		coarse_boxes.clear();
+		coarse_colors.clear();
+		// assign boxes to blocks by the centers of their footprints
+		std::map<std::pair<int, int>, std::vector<unsigned> > block_map;
+		for (unsigned bi = 0; bi < n; ++bi) {
+			vec3 c = boxes[bi].get_center();
+			block_map[std::make_pair((int)std::floor(c[0] / block_size), (int)std::floor(c[2] / block_size))].push_back(bi);
+		}
+		// source index of each box in block order
+		std::vector<unsigned> order;
+		order.reserve(n);
+		for (const auto& entry : block_map) {
+			block b;
+			b.begin = (unsigned)order.size();
+			float area_sum = 0;
+			vec3 color_sum(0.0f);
+			for (unsigned bi : entry.second) {
+				const box3& B = boxes[bi];
+				b.bounds.add_point(B.get_min_pnt());
+				b.bounds.add_point(B.get_max_pnt());
+				vec3 e = B.get_extent();
+				float area = std::abs(e[0] * e[2]);
+				area_sum += area;
+				for (int j = 0; j < 3; ++j)
+					color_sum[j] += area * colors[bi][j];
+				order.push_back(bi);
+			}
+			b.end = (unsigned)order.size();
+			if (area_sum > 0)
+				color_sum /= area_sum;
+			rgb color(color_sum[0], color_sum[1], color_sum[2]);
+			// coarse boxes cover the block footprint with the mean height such that the volume is preserved
+			b.coarse_begin = (unsigned)coarse_boxes.size();
+			vec2 p0(b.bounds.get_min_pnt()[0], b.bounds.get_min_pnt()[2]);
+			vec2 p1(b.bounds.get_max_pnt()[0], b.bounds.get_max_pnt()[2]);
+			if (hole && hole->get_min_pnt()[0] < p1[0] && hole->get_max_pnt()[0] > p0[0] &&
+				hole->get_min_pnt()[2] < p1[1] && hole->get_max_pnt()[2] > p0[1]) {
+				// split the block footprint into the strips left and right of the hole and the pieces in front of and behind it
+				float h0 = std::max(p0[0], hole->get_min_pnt()[0]), h1 = std::min(p1[0], hole->get_max_pnt()[0]);
+				add_coarse_box(boxes, entry.second, p0, vec2(h0, p1[1]), color);
+				add_coarse_box(boxes, entry.second, vec2(h1, p0[1]), p1, color);
+				add_coarse_box(boxes, entry.second, vec2(h0, p0[1]), vec2(h1, std::max(p0[1], hole->get_min_pnt()[2])), color);
+				add_coarse_box(boxes, entry.second, vec2(h0, std::min(p1[1], hole->get_max_pnt()[2])), vec2(h1, p1[1]), color);
+			}
+			else
+				add_coarse_box(boxes, entry.second, p0, p1, color);
+			b.coarse_end = (unsigned)coarse_boxes.size();
+			blocks.push_back(b);
+		}
+		// move boxes into block order by following the cycles of the permutation, which needs no second copy of the boxes
+		for (unsigned e = 0; e < order.size(); ++e) {
+			if (order[e] == e)
+				continue;
+			box3 box = boxes[e];
+			rgb color = colors[e];
+			unsigned d = e;
+			while (true) {
+				unsigned s = order[d];
+				order[d] = d;
+				if (s == e) {
+					boxes[d] = box;
+					colors[d] = color;
+					break;
+				}
+				boxes[d] = boxes[s];
+				colors[d] = colors[s];
+				d = s;
+			}
+		}
+	}
+	/// append the fine box ranges of blocks closer than lod_distance to the viewer, shifted by fine_offset, and the coarse box ranges of all others;
+	/// ranges continuing the last appended range are merged into it; returns number of blocks drawn coarse
+	size_t select(const vec3& viewer, float lod_distance, unsigned fine_offset, std::vector<range>& fine_ranges, std::vector<range>& coarse_ranges) const
+	{
+		size_t nr_coarse = 0;
+		for (size_t i = 0; i < blocks.size(); ++i) {
+			const block& b = blocks[i];
+			if (get_distance(b.bounds, viewer) < lod_distance)
+				append_range(fine_ranges, fine_offset + b.begin, b.end - b.begin);
+			else {
+				append_range(coarse_ranges, b.coarse_begin, b.coarse_end - b.coarse_begin);
+				++nr_coarse;
+			}
+		}
+		return nr_coarse;
+	}
+	/// append range to ranges or extend the last range if it ends at first
+	static void append_range(std::vector<range>& ranges, unsigned first, unsigned count)
+	{
+		if (count == 0)
+			return;
+		if (!ranges.empty() && ranges.back().first + ranges.back().count == first)
+			ranges.back().count += count;
+		else
+			ranges.push_back({ first, count });
+	}
+	/// return distance of point p to box b
+	static float get_distance(const box3& b, const vec3& p)
+	{
+		float sqr_dist = 0;
+		for (int j = 0; j < 3; ++j) {
+			float d = std::max(std::max(b.get_min_pnt()[j] - p[j], p[j] - b.get_max_pnt()[j]), 0.0f);
+			sqr_dist += d * d;
+		}
+		return std::sqrt(sqr_dist);
+	}
+	/// return number of blocks
+	size_t get_nr_blocks() const { return blocks.size(); }
+	/// access the coarse boxes of all blocks
+	const std::vector<box3>& get_coarse_boxes() const { return coarse_boxes; }
+	/// access the colors of the coarse boxes
+	const std::vector<rgb>& get_coarse_colors() const { return coarse_colors; }
+};
+
+///@}
@@ -0,0 +1,272 @@
+#pragma once
+
+#include "intersection.h"
+#include <vector>
+#include <random>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+///@ingroup NI
+///@{
+
+/**@file
+   throughput measurement and randomized validation of the ray box intersection kernel
+*/
+
+namespace cgv {
+	namespace media {
+		/// distributions of rays and boxes used to exercise the intersection kernel
+		enum RayDistribution
+		{
+			RD_RANDOM,     // random origins around random boxes with random directions
+			RD_COHERENT,   // rays from a common origin through a narrow cone as produced by picking
+			RD_ADVERSARIAL // axis parallel, grazing, tiny and degenerate directions and origins inside or on box faces
+		};
+		/// return name of ray distribution
+		inline const char* get_ray_distribution_name(RayDistribution rd)
+		{
+			static const char* names[] = { "random", "coherent", "adversarial" };
+			return names[rd];
+		}
+		/// set of rays and boxes, ray i is tested against box i
+		template <typename T>
+		struct ray_box_set
+		{
+			std::vector<cgv::math::fvec<T, 3> > origins;
+			std::vector<cgv::math::fvec<T, 3> > directions;
+			std::vector<axis_aligned_box<T, 3> > boxes;
+		};
+		/// generate n rays and boxes of the given distribution
+		template <typename T>
+		void generate_ray_box_set(RayDistribution rd, size_t n, unsigned seed, ray_box_set<T>& S)
+		{
+			typedef cgv::math::fvec<T, 3> vec_type;
+			std::default_random_engine generator(seed);
+			std::uniform_real_distribution<T> unit(T(-1), T(1));
+			std::uniform_real_distribution<T> positive(T(0.01), T(1));
+			std::uniform_int_distribution<int> axis_distribution(0, 2);
+			std::uniform_int_distribution<int> case_distribution(0, 8);
+			S.origins.resize(n);
+			S.directions.resize(n);
+			S.boxes.resize(n);
+			vec_type common_origin(unit(generator), unit(generator), T(-4));
+			for (size_t i = 0; i < n; ++i) {
+				// degenerate directions must reach the kernel unnormalized
+				bool normalize = true;
+				vec_type c(unit(generator), unit(generator), unit(generator));
+				vec_type e(positive(generator), positive(generator), positive(generator));
+				S.boxes[i] = axis_aligned_box<T, 3>(c - e, c + e);
+				vec_type& o = S.origins[i];
+				vec_type& d = S.directions[i];
+				switch (rd) {
+				case RD_RANDOM:
+					o = vec_type(T(3) * unit(generator), T(3) * unit(generator), T(3) * unit(generator));
+					d = vec_type(unit(generator), unit(generator), unit(generator));
+					break;
+				case RD_COHERENT:
+					o = common_origin;
+					d = vec_type(T(0.1) * unit(generator), T(0.1) * unit(generator), T(1));
+					break;
+				case RD_ADVERSARIAL:
+					o = vec_type(T(3) * unit(generator), T(3) * unit(generator), T(3) * unit(generator));
+					d = vec_type(unit(generator), unit(generator), unit(generator));
+					switch (case_distribution(generator)) {
+					case 0: // parallel to one or two slabs
+						d[axis_distribution(generator)] = T(0);
+						if (unit(generator) > 0)
+							d[axis_distribution(generator)] = T(0);
+						break;
+					case 1: // direction component just around the parallel threshold
+						d[axis_distribution(generator)] = T(1e-6) * unit(generator);
+						break;
+					case 2: // origin inside the box
+						o = c + T(0.9) * vec_type(e[0] * unit(generator), e[1] * unit(generator), e[2] * unit(generator));
+						break;
+					case 3: { // origin on a box face
+						int a = axis_distribution(generator);
+						o = c + vec_type(e[0] * unit(generator), e[1] * unit(generator), e[2] * unit(generator));
+						o[a] = unit(generator) > 0 ? c[a] + e[a] : c[a] - e[a];
+						break;
+					}
+					case 4: // aimed at a box corner
+						d = c + e - o;
+						break;
+					case 5: { // exactly parallel to two slabs
+						int a = axis_distribution(generator);
+						d = vec_type(T(0));
+						d[a] = unit(generator) > 0 ? T(1) : T(-1);
+						o[(a + 1) % 3] = c[(a + 1) % 3] + e[(a + 1) % 3] * unit(generator);
+						o[(a + 2) % 3] = c[(a + 2) % 3] + e[(a + 2) % 3] * unit(generator);
+						break;
+					}
+					case 6: { // grazing along a face plane
+						int a = axis_distribution(generator);
+						o[a] = unit(generator) > 0 ? c[a] + e[a] : c[a] - e[a];
+						d[a] = T(0);
+						break;
+					}
+					case 7: // parallel to all slabs with components below the threshold
+						d = T(1e-8) * vec_type(unit(generator), unit(generator), unit(generator));
+						normalize = false;
+						break;
+					case 8: // zero direction
+						d = vec_type(T(0));
+						normalize = false;
+						break;
+					}
+					break;
+				}
+				if (!normalize)
+					continue;
+				if (d.length() == T(0))
+					d[2] = T(1);
+				d.normalize();
+			}
+		}
+		/// result of a throughput measurement
+		struct ray_box_benchmark_result
+		{
+			size_t nr_rays;
+			size_t nr_hits;
+			double rays_per_second;
+		};
+		/// measure throughput of the kernel by testing all rays of S against their boxes repeat times
+		template <typename T>
+		ray_box_benchmark_result benchmark_ray_box_intersection(const ray_box_set<T>& S, unsigned repeat, T epsilon)
+		{
+			ray_box_benchmark_result result = { 0, 0, 0.0 };
+			T t_sum = 0;
+			auto start = std::chrono::high_resolution_clock::now();
+			for (unsigned r = 0; r < repeat; ++r)
+				for (size_t i = 0; i < S.origins.size(); ++i) {
+					T t;
+					cgv::math::fvec<T, 3> p, n;
+					if (ray_axis_aligned_box_intersection(S.origins[i], S.directions[i], S.boxes[i], t, p, n, epsilon)) {
+						++result.nr_hits;
+						t_sum += t;
+					}
+				}
+			double seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+			result.nr_rays = repeat * S.origins.size();
+			result.rays_per_second = seconds > 0 ? result.nr_rays / seconds : 0.0;
+			// keep the compiler from removing the loop
+			if (t_sum == std::numeric_limits<T>::max())
+				result.nr_hits = 0;
+			return result;
+		}
+		/// reference implementation in long double precision that follows the conventions of ray_axis_aligned_box_intersection for the box grown
+		/// by grow on all sides; returns the entry and exit parameters, where the entry parameter is negative for origins inside the box
+		template <typename T>
+		bool ray_axis_aligned_box_intersection_reference(
+			const cgv::math::fvec<T, 3>& origin, const cgv::math::fvec<T, 3>& direction, const axis_aligned_box<T, 3>& aabb,
+			long double grow, long double& t_entry, long double& t_exit, T epsilon)
+		{
+			typedef long double R;
+			t_entry = -std::numeric_limits<R>::max();
+			t_exit = std::numeric_limits<R>::max();
+			bool restricted = false;
+			for (int i = 0; i < 3; ++i) {
+				R o = origin[i], d = direction[i], lb = aabb.get_min_pnt()[i] - grow, ub = aabb.get_max_pnt()[i] + grow;
+				if (lb > ub)
+					return false;
+				// same threshold test as the kernel on the unconverted component
+				if (std::abs(direction[i]) < epsilon) {
+					if (o < lb || o > ub)
+						return false;
+					continue;
+				}
+				R t0 = (lb - o) / d, t1 = (ub - o) / d;
+				if (t0 > t1)
+					std::swap(t0, t1);
+				t_entry = std::max(t_entry, t0);
+				t_exit = std::min(t_exit, t1);
+				restricted = true;
+			}
+			return restricted && t_exit >= 0 && t_entry <= t_exit;
+		}
+		/// result of a validation run
+		struct ray_box_check_result
+		{
+			size_t nr_tests;
+			// tests within tolerance of a decision boundary, where either outcome is accepted but a reported hit must still lie on the box
+			size_t nr_boundary;
+			size_t nr_hit_mismatches;
+			size_t nr_t_mismatches;
+			size_t nr_normal_mismatches;
+			double max_t_error;
+			/// return whether no mismatch was found
+			bool passed() const { return nr_hit_mismatches == 0 && nr_t_mismatches == 0 && nr_normal_mismatches == 0; }
+		};
+		/// compare the kernel against the high precision reference on all rays of S; tolerance is the width of the band around decision
+		/// boundaries and the admissible error of hit parameters and points, no case is skipped
+		template <typename T>
+		ray_box_check_result check_ray_box_intersection(const ray_box_set<T>& S, T epsilon, T tolerance)
+		{
+			typedef long double R;
+			ray_box_check_result result = { 0, 0, 0, 0, 0, 0.0 };
+			for (size_t i = 0; i < S.origins.size(); ++i) {
+				++result.nr_tests;
+				const cgv::math::fvec<T, 3>& o = S.origins[i];
+				const cgv::math::fvec<T, 3>& d = S.directions[i];
+				const axis_aligned_box<T, 3>& B = S.boxes[i];
+				T t;
+				cgv::math::fvec<T, 3> p, n;
+				bool hit = ray_axis_aligned_box_intersection(o, d, B, t, p, n, epsilon);
+				// a hit is required if the ray hits the shrunk box and ruled out if it misses the grown box
+				R t_entry, t_exit, t_entry_inner, t_exit_inner, t_entry_outer, t_exit_outer;
+				bool hit_ref = ray_axis_aligned_box_intersection_reference(o, d, B, R(0), t_entry, t_exit, epsilon);
+				bool hit_inner = ray_axis_aligned_box_intersection_reference(o, d, B, -R(tolerance), t_entry_inner, t_exit_inner, epsilon);
+				bool hit_outer = ray_axis_aligned_box_intersection_reference(o, d, B, R(tolerance), t_entry_outer, t_exit_outer, epsilon);
+				if (hit_inner != hit_outer)
+					++result.nr_boundary;
+				if ((hit && !hit_outer) || (!hit && hit_inner)) {
+					++result.nr_hit_mismatches;
+					continue;
+				}
+				if (!hit)
+					continue;
+				// the kernel returns the entry parameter or the exit parameter for origins inside, which is ambiguous for origins on a face
+				bool t_ok = true;
+				if (hit_ref) {
+					R t_ref = t_entry >= 0 ? t_entry : t_exit;
+					R t_error = std::abs(t - t_ref);
+					if (std::abs(t_entry) <= tolerance)
+						t_error = std::min(std::abs(t - t_entry), std::abs(t - t_exit));
+					result.max_t_error = std::max(result.max_t_error, (double)t_error);
+					t_ok = t_error <= tolerance;
+				}
+				// in all cases the reported point has to lie on the box surface
+				R outside = 0, inside = std::numeric_limits<R>::max();
+				for (int j = 0; j < 3; ++j) {
+					R lb = B.get_min_pnt()[j], ub = B.get_max_pnt()[j];
+					outside = std::max(outside, std::max(lb - p[j], p[j] - ub));
+					inside = std::min(inside, std::min(std::abs(p[j] - lb), std::abs(p[j] - ub)));
+				}
+				if (!t_ok || outside > tolerance || inside > tolerance)
+					++result.nr_t_mismatches;
+				// the normal is a unit axis against a non parallel direction component and the point lies on a face of that axis
+				int axis = -1;
+				bool n_ok = true;
+				for (int j = 0; j < 3; ++j) {
+					if (n[j] == T(0))
+						continue;
+					if (axis != -1 || std::abs(n[j]) != T(1))
+						n_ok = false;
+					axis = j;
+				}
+				if (n_ok && axis != -1) {
+					R lb = B.get_min_pnt()[axis], ub = B.get_max_pnt()[axis];
+					n_ok = std::abs(d[axis]) >= epsilon && n[axis] == (d[axis] > T(0) ? T(-1) : T(1)) &&
+						std::min(std::abs(p[axis] - lb), std::abs(p[axis] - ub)) <= tolerance;
+				}
+				if (!n_ok || axis == -1)
+					++result.nr_normal_mismatches;
+			}
+			return result;
+		}
+	}
+}
+
+///@}
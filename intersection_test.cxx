@@ -0,0 +1,80 @@
+#include "intersection_check.h"
+#include <iostream>
+#include <string>
+
+///@ingroup NI
+///@{
+
+/**@file
+   standalone validation of the ray box intersection kernel, returns non zero if the kernel disagrees with the reference;
+   pass "benchmark" as argument to also measure throughput
+*/
+
+typedef cgv::math::fvec<float, 3> vec3;
+typedef cgv::media::axis_aligned_box<float, 3> box3;
+
+/// hand picked ray that must hit or miss the unit box
+struct directed_case
+{
+	const char* name;
+	vec3 origin, direction;
+	bool hit;
+};
+
+/// test rays whose outcome is known exactly, return number of failures
+unsigned check_directed_cases(float epsilon)
+{
+	box3 B(vec3(-1, -1, -1), vec3(1, 1, 1));
+	directed_case cases[] = {
+		{ "axis parallel hit", vec3(0.5f, 0.5f, -3), vec3(0, 0, 1), true },
+		{ "axis parallel miss", vec3(1.5f, 0.5f, -3), vec3(0, 0, 1), false },
+		{ "axis parallel behind", vec3(0.5f, 0.5f, 3), vec3(0, 0, 1), false },
+		{ "grazing along face", vec3(1, 0, -3), vec3(0, 0, 1), true },
+		{ "zero direction outside", vec3(0, 0, -3), vec3(0, 0, 0), false },
+		{ "zero direction inside", vec3(0, 0, 0), vec3(0, 0, 0), false },
+		{ "all components below threshold", vec3(0, 0, 0), vec3(1e-8f, -1e-8f, 1e-8f), false },
+		{ "origin inside", vec3(0.25f, -0.5f, 0.5f), vec3(0.6f, 0.0f, 0.8f), true },
+		{ "origin on face pointing out", vec3(0, 0, 1), vec3(0, 0, 1), true },
+		{ "through corner", vec3(-2, -2, -2), vec3(0.57735027f, 0.57735027f, 0.57735027f), true }
+	};
+	unsigned nr_failures = 0;
+	for (const directed_case& c : cases) {
+		float t;
+		vec3 p, n;
+		bool hit = cgv::media::ray_axis_aligned_box_intersection(c.origin, c.direction, B, t, p, n, epsilon);
+		if (hit != c.hit) {
+			std::cout << "directed case '" << c.name << "' " << (hit ? "hit" : "missed") << std::endl;
+			++nr_failures;
+		}
+	}
+	return nr_failures;
+}
+
+int main(int argc, char** argv)
+{
+	const float epsilon = 0.000001f, tolerance = 0.0001f;
+	unsigned nr_failures = check_directed_cases(epsilon);
+	for (int rd = cgv::media::RD_RANDOM; rd <= cgv::media::RD_ADVERSARIAL; ++rd) {
+		cgv::media::ray_box_set<float> S;
+		cgv::media::generate_ray_box_set((cgv::media::RayDistribution)rd, 100000, 2, S);
+		cgv::media::ray_box_check_result r = cgv::media::check_ray_box_intersection(S, epsilon, tolerance);
+		std::cout << cgv::media::get_ray_distribution_name((cgv::media::RayDistribution)rd) << ": "
+			<< r.nr_tests << " tests, " << r.nr_boundary << " near a boundary, "
+			<< r.nr_hit_mismatches << " hit, " << r.nr_t_mismatches << " t and "
+			<< r.nr_normal_mismatches << " normal mismatches, max t error " << r.max_t_error << std::endl;
+		if (!r.passed())
+			++nr_failures;
+	}
+	if (argc > 1 && std::string(argv[1]) == "benchmark") {
+		for (int rd = cgv::media::RD_RANDOM; rd <= cgv::media::RD_ADVERSARIAL; ++rd) {
+			cgv::media::ray_box_set<float> S;
+			cgv::media::generate_ray_box_set((cgv::media::RayDistribution)rd, 100000, 1, S);
+			cgv::media::ray_box_benchmark_result r = cgv::media::benchmark_ray_box_intersection(S, 20, epsilon);
+			std::cout << cgv::media::get_ray_distribution_name((cgv::media::RayDistribution)rd) << ": "
+				<< r.rays_per_second * 0.000001 << " Mrays/s, " << r.nr_hits << " hits of " << r.nr_rays << " rays" << std::endl;
+		}
+	}
+	return nr_failures == 0 ? 0 : 1;
+}
+
+///@}
@@ -1,957 +1,2806 @@
-#include <cgv/base/node.h>
-#include <cgv/signal/rebind.h>
-#include <cgv/base/register.h>
-#include <cgv/gui/event_handler.h>
-#include <cgv/math/ftransform.h>
-#include <cgv/utils/scan.h>
-#include <cgv/utils/options.h>
-#include <cgv/gui/provider.h>
-#include <cgv/gui/mouse_event.h>
-#include <cgv/gui/key_event.h>
-#include <cgv/render/drawable.h>
-#include <cgv/render/shader_program.h>
-#include <cgv/render/frame_buffer.h>
-#include <cgv/render/attribute_array_binding.h>
-#include <cgv_gl/box_renderer.h>
-#include <cgv_gl/sphere_renderer.h>
-#include <cgv/media/mesh/simple_mesh.h>
-#include <cgv_gl/gl/mesh_render_info.h>
-#include <cgv/gui/pose_event.h>
-
-///@ingroup NI
-///@{
-
-/**@file
-   test plugin for natural interfaces
-*/
-
-// these are the vr specific headers
-#include <vr/vr_driver.h>
-#include <cg_vr/vr_server.h>
-#include <vr_view_interactor.h>
-#include "intersection.h"
-
-// different interaction states for the controllers
-enum InteractionState
-{
-	IS_NONE,
-	IS_OVER,
-	IS_GRAB
-};
-
-/// the plugin class natural_interfaces inherits like other plugins from node, drawable and provider
-class natural_interfaces :
-	public cgv::base::node,
-	public cgv::render::drawable,
-	public cgv::gui::event_handler,
-	public cgv::gui::provider
-{
-protected:
-	struct ray {
-		vec3 origin;
-		vec3 direction;
-	};
-
-	struct plane {
-		vec3 origin;
-		vec3 normal;
-	};
-
-	float offset;
-	vec3 hit_pos;
-
-	bool intersect(ray& r, plane& p, float& t) {
-
-		float denom = dot(r.direction, p.normal);
-
-		if (fabsf(denom) > std::numeric_limits<float>::epsilon()) {
-			vec3 diff = p.origin - r.origin;
-			t = dot(diff, p.normal) / denom;
-			return t >= 0.0f;
-		}
-
-		t = -1.0f;
-		return false;
-	}
-	
-	void move_box(int& ci, vec3& pos, float& offset) {
-		auto view_ptr = find_view_as_node();
-
-		vec3 eye = view_ptr->get_eye();
-		vec3 focus = view_ptr->get_focus();
-		ray mouse_ray;
-		mouse_ray.origin = eye;
-		mouse_ray.direction = normalize(pos - eye);
-		for (size_t i = 0; i < intersection_points.size(); ++i) {
-			if (intersection_controller_indices[i] != ci)
-				continue;
-			// extract box index
-			unsigned bi = intersection_box_indices[i];
-			movable_box_translations[bi] = pos + mouse_ray.direction *offset;
-			intersection_points[i] = pos + mouse_ray.direction *offset;
-
-		}
-		post_redraw();
-	}
-
-	// mouse ray variables
-	bool mouse_ray_activated;
-	bool isGrab;
-	bool leftAct = false;
-	bool rightAct = false;
-
-	// store the scene as colored boxes
-	std::vector<box3> boxes;
-	std::vector<rgb> box_colors;
-
-	// rendering style for boxes
-	cgv::render::box_render_style style;
-
-
-	// sample for rendering a mesh
-	double mesh_scale;
-	dvec3 mesh_location;
-	dquat mesh_orientation;
-
-	// render information for mesh
-	cgv::render::mesh_render_info MI;
-
-
-	// sample for rendering text labels
-	std::string label_text;
-	int label_font_idx;
-	bool label_upright;
-	float label_size;
-	rgb label_color;
-
-	bool label_outofdate; // whether label texture is out of date
-	unsigned label_resolution; // resolution of label texture
-	cgv::render::texture label_tex; // texture used for offline rendering of label
-	cgv::render::frame_buffer label_fbo; // fbo used for offline rendering of label
-
-	// general font information
-	std::vector<const char*> font_names;
-	std::string font_enum_decl;
-
-	// current font face used
-	cgv::media::font::font_face_ptr label_font_face;
-	cgv::media::font::FontFaceAttributes label_face_type;
-
-
-	// keep deadzone and precision vector for left controller
-	cgv::gui::vr_server::vec_flt_flt left_deadzone_and_precision;
-	// store handle to vr kit of which left deadzone and precision is configured
-	void* last_kit_handle;
-
-	// length of to be rendered rays
-	float ray_length;
-
-	// keep reference to vr_view_interactor
-	vr_view_interactor* vr_view_ptr;
-
-	// store the movable boxes
-	std::vector<box3> movable_boxes;
-	std::vector<rgb> movable_box_colors;
-	std::vector<vec3> movable_box_translations;
-	std::vector<quat> movable_box_rotations;
-
-	// intersection points
-	std::vector<vec3> intersection_points;
-	std::vector<rgb>  intersection_colors;
-	std::vector<int>  intersection_box_indices;
-	std::vector<int>  intersection_controller_indices;
-
-	// state of current interaction with boxes for each controller
-	InteractionState state[4];
-
-	// render style for interaction
-	cgv::render::sphere_render_style srs;
-	cgv::render::box_render_style movable_style;
-
-	// compute intersection points of controller ray with movable boxes
-	void compute_intersections(const vec3& origin, const vec3& direction, int ci, const rgb& color)
-	{
-		for (size_t i = 0; i < movable_boxes.size(); ++i) {
-			vec3 origin_box_i = origin - movable_box_translations[i];
-			movable_box_rotations[i].inverse_rotate(origin_box_i);
-			vec3 direction_box_i = direction;
-			movable_box_rotations[i].inverse_rotate(direction_box_i);
-			float t_result;
-			vec3  p_result;
-			vec3  n_result;
-			if (cgv::media::ray_axis_aligned_box_intersection(
-				origin_box_i, direction_box_i,
-				movable_boxes[i],
-				t_result, p_result, n_result, 0.000001f)) {
-
-				// transform result back to world coordinates
-				movable_box_rotations[i].rotate(p_result);
-				p_result += movable_box_translations[i];
-				movable_box_rotations[i].rotate(n_result);
-
-				// store intersection information
-				intersection_points.push_back(p_result);
-				intersection_colors.push_back(color);
-				intersection_box_indices.push_back((int)i);
-				intersection_controller_indices.push_back(ci);
-			}
-		}
-	}
-	/// register on device change events
-	void on_device_change(void* kit_handle, bool attach)
-	{
-		if (attach) {
-			if (last_kit_handle == 0) {
-				vr::vr_kit* kit_ptr = vr::get_vr_kit(kit_handle);
-				if (kit_ptr) {
-					last_kit_handle = kit_handle;
-					left_deadzone_and_precision = kit_ptr->get_controller_throttles_and_sticks_deadzone_and_precision(0);
-					cgv::gui::ref_vr_server().provide_controller_throttles_and_sticks_deadzone_and_precision(kit_handle, 0, &left_deadzone_and_precision);
-					post_recreate_gui();
-				}
-			}
-		}
-		else {
-			if (kit_handle == last_kit_handle) {
-				last_kit_handle = 0;
-				post_recreate_gui();
-			}
-		}
-	}
-	/// construct boxes that represent a table of dimensions tw,td,th and leg width tW
-	void construct_table(float tw, float td, float th, float tW);
-	/// construct boxes that represent a room of dimensions w,d,h and wall width W
-	void construct_room(float w, float d, float h, float W, bool walls, bool ceiling);
-	/// construct boxes for environment
-	void construct_environment(float s, float ew, float ed, float eh, float w, float d, float h);
-	/// construct boxes that represent a table of dimensions tw,td,th and leg width tW
-	void construct_movable_boxes(float tw, float td, float th, float tW, size_t nr);
-	/// construct a scene with a table
-	void build_scene(float w, float d, float h, float W,
-		float tw, float td, float th, float tW)
-	{
-		construct_room(w, d, h, W, false, false);
-		construct_table(tw, td, th, tW);
-		construct_environment(0.2f, 3 * w, 3 * d, h, w, d, h);
-		construct_movable_boxes(tw, td, th, tW, 20);
-	}
-public:
-	natural_interfaces()
-	{
-
-		set_name("natural_interfaces");
-		build_scene(5, 7, 3, 0.2f, 1.6f, 0.8f, 0.9f, 0.03f);
-		vr_view_ptr = 0;
-		ray_length = 2;
-		last_kit_handle = 0;
-		connect(cgv::gui::ref_vr_server().on_device_change, this, &natural_interfaces::on_device_change);
-
-		mesh_scale = 0.001f;
-		mesh_location = dvec3(0, 1.1f, 0);
-		mesh_orientation = dquat(1, 0, 0, 0);
-
-		srs.radius = 0.005f;
-
-		label_outofdate = true;
-		label_text = "Info Board";
-		label_font_idx = 0;
-		label_upright = true;
-		label_face_type = cgv::media::font::FFA_BOLD;
-		label_resolution = 256;
-		label_size = 20.0f;
-		label_color = rgb(1, 1, 1);
-
-		//Mouse Events
-		mouse_ray_activated = false;
-		isGrab = false;
-		offset = 0.0f;
-		hit_pos(0.0f);
-
-		cgv::media::font::enumerate_font_names(font_names);
-		font_enum_decl = "enums='";
-		for (unsigned i = 0; i < font_names.size(); ++i) {
-			if (i > 0)
-				font_enum_decl += ";";
-			std::string fn(font_names[i]);
-			if (cgv::utils::to_lower(fn) == "calibri") {
-				label_font_face = cgv::media::font::find_font(fn)->get_font_face(label_face_type);
-				label_font_idx = i;
-			}
-			font_enum_decl += std::string(fn);
-		}
-		font_enum_decl += "'";
-		state[0] = state[1] = state[2] = state[3] = IS_NONE;
-	}
-	std::string get_type_name() const
-	{
-		return "natural_interfaces";
-	}
-	void create_gui()
-	{
-		add_decorator("natural_interfaces", "heading", "level=2");
-		add_member_control(this, "mesh_scale", mesh_scale, "value_slider", "min=0.1;max=10;log=true;ticks=true");
-		add_gui("mesh_location", mesh_location, "vector", "options='min=-3;max=3;ticks=true");
-		add_gui("mesh_orientation", static_cast<dvec4&>(mesh_orientation), "direction", "options='min=-1;max=1;ticks=true");
-		add_member_control(this, "ray_length", ray_length, "value_slider", "min=0.1;max=10;log=true;ticks=true");
-		if (last_kit_handle) {
-			vr::vr_kit* kit_ptr = vr::get_vr_kit(last_kit_handle);
-			const std::vector<std::pair<int, int> >* t_and_s_ptr = 0;
-			if (kit_ptr)
-				t_and_s_ptr = &kit_ptr->get_controller_throttles_and_sticks(0);
-			add_decorator("deadzone and precisions", "heading", "level=3");
-			int ti = 0;
-			int si = 0;
-			for (unsigned i = 0; i < left_deadzone_and_precision.size(); ++i) {
-				std::string prefix = std::string("unknown[") + cgv::utils::to_string(i) + "]";
-				if (t_and_s_ptr) {
-					if (t_and_s_ptr->at(i).second == -1)
-						prefix = std::string("throttle[") + cgv::utils::to_string(ti++) + "]";
-					else
-						prefix = std::string("stick[") + cgv::utils::to_string(si++) + "]";
-				}
-				add_member_control(this, prefix + ".deadzone", left_deadzone_and_precision[i].first, "value_slider", "min=0;max=1;ticks=true;log=true");
-				add_member_control(this, prefix + ".precision", left_deadzone_and_precision[i].second, "value_slider", "min=0;max=1;ticks=true;log=true");
-			}
-		}
-		if (begin_tree_node("box style", style)) {
-			align("\a");
-			add_gui("box style", style);
-			align("\b");
-			end_tree_node(style);
-		}
-		if (begin_tree_node("movable box style", movable_style)) {
-			align("\a");
-			add_gui("movable box style", movable_style);
-			align("\b");
-			end_tree_node(movable_style);
-		}
-		if (begin_tree_node("intersections", srs)) {
-			align("\a");
-			add_gui("sphere style", srs);
-			align("\b");
-			end_tree_node(srs);
-		}
-		if (begin_tree_node("mesh", mesh_scale)) {
-			align("\a");
-			add_member_control(this, "scale", mesh_scale, "value_slider", "min=0.0001;step=0.0000001;max=100;log=true;ticks=true");
-			add_gui("location", mesh_location, "", "main_label='';long_label=true;gui_type='value_slider';options='min=-2;max=2;step=0.001;ticks=true'");
-			add_gui("orientation", static_cast<dvec4&>(mesh_orientation), "direction", "main_label='';long_label=true;gui_type='value_slider';options='min=-1;max=1;step=0.001;ticks=true'");
-			align("\b");
-			end_tree_node(mesh_scale);
-		}
-
-		if (begin_tree_node("label", label_size)) {
-			align("\a");
-			add_member_control(this, "text", label_text);
-			add_member_control(this, "upright", label_upright);
-			add_member_control(this, "font", (cgv::type::DummyEnum&)label_font_idx, "dropdown", font_enum_decl);
-			add_member_control(this, "face", (cgv::type::DummyEnum&)label_face_type, "dropdown", "enums='regular,bold,italics,bold+italics'");
-			add_member_control(this, "size", label_size, "value_slider", "min=8;max=64;ticks=true");
-			add_member_control(this, "color", label_color);
-			add_member_control(this, "resolution", (cgv::type::DummyEnum&)label_resolution, "dropdown", "enums='256=256,512=512,1024=1024,2048=2048'");
-			align("\b");
-			end_tree_node(label_size);
-		}
-	}
-	void on_set(void* member_ptr)
-	{
-		if (member_ptr == &label_face_type || member_ptr == &label_font_idx) {
-			label_font_face = cgv::media::font::find_font(font_names[label_font_idx])->get_font_face(label_face_type);
-			label_outofdate = true;
-		}
-		if ((member_ptr >= &label_color && member_ptr < &label_color + 1) ||
-			member_ptr == &label_size || member_ptr == &label_text) {
-			label_outofdate = true;
-		}
-		update_member(member_ptr);
-		post_redraw();
-	}
-	void stream_help(std::ostream& os)
-	{
-		os << "vr_test: no shortcuts defined" << std::endl;
-	}
-	bool handle(cgv::gui::event& e)
-	{
-		auto view_ptr = find_view_as_node();
-		cgv::render::context* ctx = get_context();
-
-		if (e.get_kind() == cgv::gui::EID_KEY) {
-			cgv::gui::key_event ke = (cgv::gui::key_event&) e;
-			if (ke.get_action() != cgv::gui::KA_RELEASE)
-				if (ke.get_key() == 'C')
-					if (mouse_ray_activated)
-							mouse_ray_activated = false;
-					else
-						mouse_ray_activated = true;
-
-		}
-		if (mouse_ray_activated) {
-			if (e.get_kind() == cgv::gui::EID_MOUSE)  {
-				cgv::gui::mouse_event me = (cgv::gui::mouse_event&) e;
-				
-				int ci = 0;
-
-				if (me.get_action() == cgv::gui::MA_PRESS) {
-					if (me.get_button() == cgv::gui::MB_LEFT_BUTTON) {
-						leftAct = true;
-
-						unsigned x = me.get_x();
-						unsigned y = me.get_y();
-						vec3 pos(0.0f);
-						view_ptr->get_z_and_unproject(*ctx, x, y, pos);
-
-						vec3 eye = view_ptr->get_eye();
-						vec3 focus = view_ptr->get_focus();
-
-						vec3 direction = normalize(pos - eye);
-
-						compute_intersections(eye, direction, ci, ci == 0 ? rgb(1, 0, 0) : rgb(0, 0, 1));
-						if (intersection_points.size()) {
-							isGrab = true;
-							std::cout << "Box chosen with left mouse" << std::endl;
-							post_redraw();
-						}
-
-						label_outofdate = true; //Shows the chosen box on the info board
-					}
-					else if (me.get_button() == cgv::gui::MB_RIGHT_BUTTON) {
-						rightAct = true;
-
-						unsigned x = me.get_x();
-						unsigned y = me.get_y();
-						vec3 pos(0.0f);
-						view_ptr->get_z_and_unproject(*ctx, x, y, pos);
-
-						vec3 eye = view_ptr->get_eye();
-						vec3 focus = view_ptr->get_focus();
-
-						vec3 direction = normalize(pos - eye);
-
-						compute_intersections(eye, direction, ci, ci == 0 ? rgb(1, 0, 0) : rgb(0, 0, 1));
-						if (intersection_points.size()) {
-							isGrab = true;
-							std::cout << "Box chosen with right mouse" << std::endl;
-							post_redraw();
-						}
-
-						label_outofdate = true; //Shows the chosen box on the info board
-
-					}
-
-				}
-				else if (me.get_action() == cgv::gui::MA_RELEASE) {
-					if (isGrab) {
-						isGrab = false;
-						leftAct = false;
-						rightAct = false;
-						offset = 0.0f;
-						size_t i = 0;
-						while (i < intersection_points.size()) {
-							if (intersection_controller_indices[i] == ci) {
-								intersection_points.erase(intersection_points.begin() + i);
-								intersection_colors.erase(intersection_colors.begin() + i);
-								intersection_box_indices.erase(intersection_box_indices.begin() + i);
-								intersection_controller_indices.erase(intersection_controller_indices.begin() + i);
-							}
-							else
-								++i;
-						}
-						std::cout << "Released" << std::endl;
-						offset = 0;
-						post_redraw();
-					}
-				}
-				else if (me.get_action() == cgv::gui::MA_DRAG && isGrab) {
-					unsigned changed_x = me.get_x();
-					unsigned changed_y = me.get_y();
-					vec3 pos(0.0f);
-					view_ptr->get_z_and_unproject(*ctx, changed_x, changed_y, pos);
-
-					if (leftAct) {
-						std::cout << "left mouse activated" << std::endl;
-
-						vec3 eye = view_ptr->get_eye();
-						vec3 focus = view_ptr->get_focus();
-						ray mouse_ray;
-						mouse_ray.origin = eye;
-						mouse_ray.direction = normalize(pos - eye);
-
-						plane mouse_plane;
-						mouse_plane.origin = focus;
-						mouse_plane.normal = normalize(focus - eye);
-						float t = 0.0f;
-						bool hit = intersect(mouse_ray, mouse_plane, t);
-
-						if (hit) {
-							hit_pos = mouse_ray.origin + t * mouse_ray.direction;
-							move_box(ci, hit_pos, offset);
-							std::cout << "Dragging" << std::endl;
-						}
-					}
-					else if (rightAct) {
-						std::cout << "right mouse activated" << std::endl;
-
-						// Gives the change of mouse position based on x and y axis, if the mouse movement is slow and gentle always changes by +1 or -1, it can goes high up as <+-92 depending on how sharp the change is
-						double x = me.get_dx(); 
-						double y = me.get_dy(); 
-						
-						quat rot_x = quat(vec3(1.0f, 0.0f, 0.0f), cgv::math::deg2rad(x*2));
-						quat rot_y = quat(vec3(0.0f, 1.0f, 0.0f), cgv::math::deg2rad(y*2));
-						quat rot_combined = rot_x * rot_y;
-						
-						std::cout << "x: " << x << std::endl;
-						std::cout << "y: " << y << std::endl;
-
-						for (size_t i = 0; i < intersection_points.size(); ++i) {
-							if (intersection_controller_indices[i] != ci)
-								continue;
-							// extract box index
-							unsigned bi = intersection_box_indices[i];
-
-							//vec3 pos(1.0f, 0.0f, 0.0f);
-							//auto thing1 = rot_combined.apply(pos);
-
-							movable_box_rotations[bi] *= rot_combined;
-
-							std::cout << "Rotating2" << std::endl;
-						}
-						post_redraw();
-						std::cout << "Rotating" << std::endl;
-					}
-					
-				}
-				else if (me.get_action() == cgv::gui::MA_WHEEL && isGrab) {
-					std::cout << "Rolling:"<<me.get_dy() << std::endl;
-					offset += 0.1f * me.get_dy();
-					move_box(ci, hit_pos, offset);
-					return true;
-				}
-			}
-		}
-
-		// check if vr event flag is not set and don't process events in this case
-		if ((e.get_flags() & cgv::gui::EF_VR) == 0)
-			return false;
-		// check event id
-		/*
-		switch (e.get_kind()) {
-		case cgv::gui::EID_KEY:
-		{
-			cgv::gui::vr_key_event& vrke = static_cast<cgv::gui::vr_key_event&>(e);
-			if (vrke.get_action() != cgv::gui::KA_RELEASE) {
-				switch (vrke.get_key()) {
-				case vr::VR_LEFT_BUTTON0:
-					std::cout << "button 0 of left controller pressed" << std::endl;
-					return true;
-				case vr::VR_RIGHT_STICK_RIGHT:
-					std::cout << "touch pad of right controller pressed at right direction" << std::endl;
-					return true;
-				}
-			}
-			break;
-		}
-		case cgv::gui::EID_THROTTLE:
-		{
-			cgv::gui::vr_throttle_event& vrte = static_cast<cgv::gui::vr_throttle_event&>(e);
-			std::cout << "throttle " << vrte.get_throttle_index() << " of controller " << vrte.get_controller_index()
-				<< " adjusted from " << vrte.get_last_value() << " to " << vrte.get_value() << std::endl;
-			return true;
-		}
-		case cgv::gui::EID_STICK:
-		{
-			cgv::gui::vr_stick_event& vrse = static_cast<cgv::gui::vr_stick_event&>(e);
-			switch (vrse.get_action()) {
-			case cgv::gui::SA_TOUCH:
-				if (state[vrse.get_controller_index()] == IS_OVER)
-					state[vrse.get_controller_index()] = IS_GRAB;
-				break;
-			case cgv::gui::SA_RELEASE:
-				if (state[vrse.get_controller_index()] == IS_GRAB)
-					state[vrse.get_controller_index()] = IS_OVER;
-				break;
-			case cgv::gui::SA_PRESS:
-			case cgv::gui::SA_UNPRESS:
-				std::cout << "stick " << vrse.get_stick_index()
-					<< " of controller " << vrse.get_controller_index()
-					<< " " << cgv::gui::get_stick_action_string(vrse.get_action())
-					<< " at " << vrse.get_x() << ", " << vrse.get_y() << std::endl;
-				return true;
-			case cgv::gui::SA_MOVE:
-			case cgv::gui::SA_DRAG:
-				std::cout << "stick " << vrse.get_stick_index()
-					<< " of controller " << vrse.get_controller_index()
-					<< " " << cgv::gui::get_stick_action_string(vrse.get_action())
-					<< " from " << vrse.get_last_x() << ", " << vrse.get_last_y()
-					<< " to " << vrse.get_x() << ", " << vrse.get_y() << std::endl;
-				return true;
-			}
-			return true;
-		}
-		case cgv::gui::EID_POSE:
-			cgv::gui::vr_pose_event& vrpe = static_cast<cgv::gui::vr_pose_event&>(e);
-			// check for controller pose events
-			int ci = vrpe.get_trackable_index();
-			if (ci != -1) {
-				if (state[ci] == IS_GRAB) {
-					// in grab mode apply relative transformation to grabbed boxes
-
-					// get previous and current controller position
-					vec3 last_pos = vrpe.get_last_position();
-					vec3 pos = vrpe.get_position();
-					// get rotation from previous to current orientation
-					// this is the current orientation matrix times the
-					// inverse (or transpose) of last orientation matrix:
-					// vrpe.get_orientation()*transpose(vrpe.get_last_orientation())
-					mat3 rotation = vrpe.get_rotation_matrix();
-					// iterate intersection points of current controller
-					for (size_t i = 0; i < intersection_points.size(); ++i) {
-						if (intersection_controller_indices[i] != ci)
-							continue;
-						// extract box index
-						unsigned bi = intersection_box_indices[i];
-						// update translation with position change and rotation
-						movable_box_translations[bi] =
-							rotation * (movable_box_translations[bi] - last_pos) + pos;
-						// update orientation with rotation, note that quaternions
-						// need to be multiplied in oposite order. In case of matrices
-						// one would write box_orientation_matrix *= rotation
-						movable_box_rotations[bi] = quat(rotation) * movable_box_rotations[bi];
-						// update intersection points
-						intersection_points[i] = rotation * (intersection_points[i] - last_pos) + pos;
-					}
-				}
-				else {// not grab
-					// clear intersections of current controller
-					size_t i = 0;
-					while (i < intersection_points.size()) {
-						if (intersection_controller_indices[i] == ci) {
-							intersection_points.erase(intersection_points.begin() + i);
-							intersection_colors.erase(intersection_colors.begin() + i);
-							intersection_box_indices.erase(intersection_box_indices.begin() + i);
-							intersection_controller_indices.erase(intersection_controller_indices.begin() + i);
-						}
-						else
-							++i;
-					}
-
-					// compute intersections
-					vec3 origin, direction;
-					vrpe.get_state().controller[ci].put_ray(&origin(0), &direction(0));
-					compute_intersections(origin, direction, ci, ci == 0 ? rgb(1, 0, 0) : rgb(0, 0, 1));
-					label_outofdate = true;
-
-
-					// update state based on whether we have found at least 
-					// one intersection with controller ray
-					if (intersection_points.size() == i)
-						state[ci] = IS_NONE;
-					else
-						if (state[ci] == IS_NONE)
-							state[ci] = IS_OVER;
-				}
-				post_redraw();
-			}
-			return true;
-		}
-		*/
-		return false;
-	}
-	bool init(cgv::render::context& ctx)
-	{
-		if (!cgv::utils::has_option("NO_OPENVR"))
-			ctx.set_gamma(1.0f);
-		cgv::media::mesh::simple_mesh<> M;
-#ifdef _DEBUG
-		if (M.read("D:/data/surface/meshes/obj/Max-Planck_lowres.obj")) {
-#else
-		if (M.read("D:/data/surface/meshes/obj/Max-Planck_highres.obj")) {
-#endif
-			MI.construct(ctx, M);
-			MI.bind(ctx, ctx.ref_surface_shader_program(true),true);
-		}
-		cgv::gui::connect_vr_server(true);
-
-		auto view_ptr = find_view_as_node();
-		if (view_ptr) {
-			view_ptr->set_eye_keep_view_angle(dvec3(0, 4, -4));
-			// if the view points to a vr_view_interactor
-			vr_view_ptr = dynamic_cast<vr_view_interactor*>(view_ptr);
-			if (vr_view_ptr) {
-				// configure vr event processing
-				vr_view_ptr->set_event_type_flags(
-					cgv::gui::VREventTypeFlags(
-						cgv::gui::VRE_KEY +
-						cgv::gui::VRE_THROTTLE +
-						cgv::gui::VRE_STICK +
-						cgv::gui::VRE_STICK_KEY +
-						cgv::gui::VRE_POSE
-					));
-				vr_view_ptr->enable_vr_event_debugging(false);
-				// configure vr rendering
-				vr_view_ptr->draw_action_zone(false);
-				vr_view_ptr->draw_vr_kits(true);
-				vr_view_ptr->enable_blit_vr_views(true);
-				vr_view_ptr->set_blit_vr_view_width(200);
-
-			}
-		}
-		cgv::render::ref_box_renderer(ctx, 1);
-		cgv::render::ref_sphere_renderer(ctx, 1);
-		return true;
-		}
-	void clear(cgv::render::context & ctx)
-	{
-		cgv::render::ref_box_renderer(ctx, -1);
-		cgv::render::ref_sphere_renderer(ctx, -1);
-	}
-	void init_frame(cgv::render::context & ctx)
-	{
-		if (label_fbo.get_width() != label_resolution) {
-			label_tex.destruct(ctx);
-			label_fbo.destruct(ctx);
-		}
-		if (!label_fbo.is_created()) {
-			label_tex.create(ctx, cgv::render::TT_2D, label_resolution, label_resolution);
-			label_fbo.create(ctx, label_resolution, label_resolution);
-			label_tex.set_min_filter(cgv::render::TF_LINEAR_MIPMAP_LINEAR);
-			label_tex.set_mag_filter(cgv::render::TF_LINEAR);
-			label_fbo.attach(ctx, label_tex);
-			label_outofdate = true;
-		}
-		if (label_outofdate && label_fbo.is_complete(ctx)) {
-			glPushAttrib(GL_COLOR_BUFFER_BIT);
-			label_fbo.enable(ctx);
-			label_fbo.push_viewport(ctx);
-			ctx.push_pixel_coords();
-			glClearColor(0.5f, 0.5f, 0.5f, 1.0f);
-			glClear(GL_COLOR_BUFFER_BIT);
-
-			glColor4f(label_color[0], label_color[1], label_color[2], 1);
-			ctx.set_cursor(20, (int)ceil(label_size) + 20);
-			ctx.enable_font_face(label_font_face, label_size);
-			ctx.output_stream() << label_text << "\n";
-			ctx.output_stream().flush(); // make sure to flush the stream before change of font size or font face
-
-			ctx.enable_font_face(label_font_face, 0.7f * label_size);
-			for (size_t i = 0; i < intersection_points.size(); ++i) {
-				ctx.output_stream()
-					<< "box " << intersection_box_indices[i]
-					<< " at (" << intersection_points[i]
-					<< ") with controller " << intersection_controller_indices[i] << "\n";
-			}
-			ctx.output_stream().flush();
-
-			ctx.pop_pixel_coords();
-			label_fbo.pop_viewport(ctx);
-			label_fbo.disable(ctx);
-			glPopAttrib();
-			label_outofdate = false;
-
-			label_tex.generate_mipmaps(ctx);
-		}
-	}
-	void draw(cgv::render::context & ctx)
-	{
-		if (MI.is_constructed()) {
-			dmat4 R;
-			mesh_orientation.put_homogeneous_matrix(R);
-			ctx.push_modelview_matrix();
-			ctx.mul_modelview_matrix(
-				cgv::math::translate4<double>(mesh_location) *
-				cgv::math::scale4<double>(mesh_scale, mesh_scale, mesh_scale) *
-				R);
-			MI.bind(ctx, ctx.ref_surface_shader_program(true), true);
-			ctx.pop_modelview_matrix();
-		}
-		if (vr_view_ptr) {
-			std::vector<vec3> P;
-			std::vector<rgb> C;
-			const vr::vr_kit_state* state_ptr = vr_view_ptr->get_current_vr_state();
-			if (state_ptr) {
-				for (int ci = 0; ci < 4; ++ci) if (state_ptr->controller[ci].status == vr::VRS_TRACKED) {
-					vec3 ray_origin, ray_direction;
-					state_ptr->controller[ci].put_ray(&ray_origin(0), &ray_direction(0));
-					P.push_back(ray_origin);
-					P.push_back(ray_origin + ray_length * ray_direction);
-					rgb c(float(1 - ci), 0.5f * (int)state[ci], float(ci));
-					C.push_back(c);
-					C.push_back(c);
-				}
-			}
-			if (P.size() > 0) {
-				cgv::render::shader_program& prog = ctx.ref_default_shader_program();
-				int pi = prog.get_position_index();
-				int ci = prog.get_color_index();
-				cgv::render::attribute_array_binding::set_global_attribute_array(ctx, pi, P);
-				cgv::render::attribute_array_binding::enable_global_array(ctx, pi);
-				cgv::render::attribute_array_binding::set_global_attribute_array(ctx, ci, C);
-				cgv::render::attribute_array_binding::enable_global_array(ctx, ci);
-				glLineWidth(3);
-				prog.enable(ctx);
-				glDrawArrays(GL_LINES, 0, (GLsizei)P.size());
-				prog.disable(ctx);
-				cgv::render::attribute_array_binding::disable_global_array(ctx, pi);
-				cgv::render::attribute_array_binding::disable_global_array(ctx, ci);
-				glLineWidth(1);
-			}
-		}
-		// draw static boxes
-		cgv::render::box_renderer& renderer = cgv::render::ref_box_renderer(ctx);
-		renderer.set_render_style(style);
-		renderer.set_box_array(ctx, boxes);
-		renderer.set_color_array(ctx, box_colors);
-		if (renderer.validate_and_enable(ctx)) {
-			glDrawArrays(GL_POINTS, 0, (GLsizei)boxes.size());
-		}
-		renderer.disable(ctx);
-
-		// draw dynamic boxes 
-		renderer.set_render_style(movable_style);
-		renderer.set_box_array(ctx, movable_boxes);
-		renderer.set_color_array(ctx, movable_box_colors);
-		renderer.set_translation_array(ctx, movable_box_translations);
-		renderer.set_rotation_array(ctx, movable_box_rotations);
-		if (renderer.validate_and_enable(ctx)) {
-			glDrawArrays(GL_POINTS, 0, (GLsizei)movable_boxes.size());
-		}
-		renderer.disable(ctx);
-
-		// draw intersection points
-		if (!intersection_points.empty()) {
-			auto& sr = cgv::render::ref_sphere_renderer(ctx);
-			sr.set_position_array(ctx, intersection_points);
-			sr.set_color_array(ctx, intersection_colors);
-			sr.set_render_style(srs);
-			if (sr.validate_and_enable(ctx)) {
-				glDrawArrays(GL_POINTS, 0, (GLsizei)intersection_points.size());
-				sr.disable(ctx);
-			}
-		}
-
-		// draw label
-		if (label_tex.is_created()) {
-			cgv::render::shader_program& prog = ctx.ref_default_shader_program(true);
-			int pi = prog.get_position_index();
-			int ti = prog.get_texcoord_index();
-			vec3 p(0, 1.5f, 0);
-			vec3 y = label_upright ? vec3(0, 1.0f, 0) : normalize(vr_view_ptr->get_view_up_dir_of_kit());
-			vec3 x = normalize(cross(vec3(vr_view_ptr->get_view_dir_of_kit()), y));
-			float w = 0.5f, h = 0.5f;
-			std::vector<vec3> P;
-			std::vector<vec2> T;
-			P.push_back(p - 0.5f * w * x - 0.5f * h * y); T.push_back(vec2(0.0f, 0.0f));
-			P.push_back(p + 0.5f * w * x - 0.5f * h * y); T.push_back(vec2(1.0f, 0.0f));
-			P.push_back(p - 0.5f * w * x + 0.5f * h * y); T.push_back(vec2(0.0f, 1.0f));
-			P.push_back(p + 0.5f * w * x + 0.5f * h * y); T.push_back(vec2(1.0f, 1.0f));
-			cgv::render::attribute_array_binding::set_global_attribute_array(ctx, pi, P);
-			cgv::render::attribute_array_binding::enable_global_array(ctx, pi);
-			cgv::render::attribute_array_binding::set_global_attribute_array(ctx, ti, T);
-			cgv::render::attribute_array_binding::enable_global_array(ctx, ti);
-			prog.enable(ctx);
-			label_tex.enable(ctx);
-			ctx.set_color(rgb(1, 1, 1));
-			glDrawArrays(GL_TRIANGLE_STRIP, 0, (GLsizei)P.size());
-			label_tex.disable(ctx);
-			prog.disable(ctx);
-			cgv::render::attribute_array_binding::disable_global_array(ctx, pi);
-			cgv::render::attribute_array_binding::disable_global_array(ctx, ti);
-		}
-	}
-	};
-
-/// construct boxes that represent a table of dimensions tw,td,th and leg width tW
-void natural_interfaces::construct_table(float tw, float td, float th, float tW)
-{
-	// construct table
-	rgb table_clr(0.3f, 0.2f, 0.0f);
-	boxes.push_back(box3(
-		vec3(-0.5f * tw - 2 * tW, th, -0.5f * td - 2 * tW),
-		vec3(0.5f * tw + 2 * tW, th + tW, 0.5f * td + 2 * tW)));
-	box_colors.push_back(table_clr);
-
-	boxes.push_back(box3(vec3(-0.5f * tw, 0, -0.5f * td), vec3(-0.5f * tw - tW, th, -0.5f * td - tW)));
-	boxes.push_back(box3(vec3(-0.5f * tw, 0, 0.5f * td), vec3(-0.5f * tw - tW, th, 0.5f * td + tW)));
-	boxes.push_back(box3(vec3(0.5f * tw, 0, -0.5f * td), vec3(0.5f * tw + tW, th, -0.5f * td - tW)));
-	boxes.push_back(box3(vec3(0.5f * tw, 0, 0.5f * td), vec3(0.5f * tw + tW, th, 0.5f * td + tW)));
-	box_colors.push_back(table_clr);
-	box_colors.push_back(table_clr);
-	box_colors.push_back(table_clr);
-	box_colors.push_back(table_clr);
-}
-/// construct boxes that represent a room of dimensions w,d,h and wall width W
-void natural_interfaces::construct_room(float w, float d, float h, float W, bool walls, bool ceiling)
-{
-	// construct floor
-	boxes.push_back(box3(vec3(-0.5f * w, -W, -0.5f * d), vec3(0.5f * w, 0, 0.5f * d)));
-	box_colors.push_back(rgb(0.2f, 0.2f, 0.2f));
-
-	if (walls) {
-		// construct walls
-		boxes.push_back(box3(vec3(-0.5f * w, -W, -0.5f * d - W), vec3(0.5f * w, h, -0.5f * d)));
-		box_colors.push_back(rgb(0.8f, 0.5f, 0.5f));
-		boxes.push_back(box3(vec3(-0.5f * w, -W, 0.5f * d), vec3(0.5f * w, h, 0.5f * d + W)));
-		box_colors.push_back(rgb(0.8f, 0.5f, 0.5f));
-
-		boxes.push_back(box3(vec3(0.5f * w, -W, -0.5f * d - W), vec3(0.5f * w + W, h, 0.5f * d + W)));
-		box_colors.push_back(rgb(0.5f, 0.8f, 0.5f));
-	}
-	if (ceiling) {
-		// construct ceiling
-		boxes.push_back(box3(vec3(-0.5f * w - W, h, -0.5f * d - W), vec3(0.5f * w + W, h + W, 0.5f * d + W)));
-		box_colors.push_back(rgb(0.5f, 0.5f, 0.8f));
-	}
-}
-
-#include <random>
-
-/// construct boxes for environment
-void natural_interfaces::construct_environment(float s, float ew, float ed, float eh, float w, float d, float h)
-{
-	std::default_random_engine generator;
-	std::uniform_real_distribution<float> distribution(0, 1);
-	unsigned n = unsigned(ew / s);
-	unsigned m = unsigned(ed / s);
-	for (unsigned i = 0; i < n; ++i) {
-		float x = i * s - 0.5f * ew;
-		for (unsigned j = 0; j < m; ++j) {
-			float z = j * s - 0.5f * ed;
-			if ((x + 0.5f * s > -0.5f * w && x < 0.5f * w) && (z + 0.5f * s > -0.5f * d && z < 0.5f * d))
-				continue;
-			float h = 0.2f * (std::max(abs(x) - 0.5f * w, 0.0f) + std::max(abs(z) - 0.5f * d, 0.0f)) * distribution(generator) + 0.1f;
-			boxes.push_back(box3(vec3(x, 0, z), vec3(x + s, h, z + s)));
-			box_colors.push_back(
-				rgb(0.3f * distribution(generator) + 0.3f,
-					0.3f * distribution(generator) + 0.2f,
-					0.2f * distribution(generator) + 0.1f));
-		}
-	}
-}
-
-/// construct boxes that can be moved around
-void natural_interfaces::construct_movable_boxes(float tw, float td, float th, float tW, size_t nr)
-{
-	std::default_random_engine generator;
-	std::uniform_real_distribution<float> distribution(0, 1);
-	std::uniform_real_distribution<float> signed_distribution(-1, 1);
-	for (size_t i = 0; i < nr; ++i) {
-		float x = distribution(generator);
-		float y = distribution(generator);
-		vec3 extent(distribution(generator), distribution(generator), distribution(generator));
-		extent += 0.1f;
-		extent *= std::min(tw, td) * 0.2f;
-
-		vec3 center(-0.5f * tw + x * tw, th + tW, -0.5f * td + y * td);
-		movable_boxes.push_back(box3(-0.5f * extent, 0.5f * extent));
-		movable_box_colors.push_back(rgb(distribution(generator), distribution(generator), distribution(generator)));
-		movable_box_translations.push_back(center);
-		quat rot(signed_distribution(generator), signed_distribution(generator), signed_distribution(generator), signed_distribution(generator));
-		rot.normalize();
-		movable_box_rotations.push_back(rot);
-	}
-}
-
-#include <cgv/base/register.h>
-
-cgv::base::object_registration<natural_interfaces> natural_interfaces_reg("");
-
+#include <cgv/base/node.h>
+#include <cgv/signal/rebind.h>
+#include <cgv/base/register.h>
+#include <cgv/gui/event_handler.h>
+#include <cgv/math/ftransform.h>
+#include <cgv/utils/scan.h>
+#include <cgv/utils/options.h>
+#include <cgv/gui/provider.h>
+#include <cgv/gui/mouse_event.h>
+#include <cgv/gui/key_event.h>
+#include <cgv/render/drawable.h>
+#include <cgv/render/shader_program.h>
+#include <cgv/render/frame_buffer.h>
+#include <cgv/render/attribute_array_binding.h>
+#include <cgv/render/vertex_buffer.h>
+#include <cgv_gl/box_renderer.h>
+#include <cgv_gl/renderer.h>
+#include <cgv_gl/sphere_renderer.h>
+#include <cgv/media/mesh/simple_mesh.h>
+#include <cgv_gl/gl/mesh_render_info.h>
+#include <cgv/gui/pose_event.h>
+#include <cgv/gui/trigger.h>
+
+///@ingroup NI
+///@{
+
+/**@file
+   test plugin for natural interfaces
+*/
+
+// these are the vr specific headers
+#include <vr/vr_driver.h>
+#include <cg_vr/vr_server.h>
+#include <vr_view_interactor.h>
+#include "intersection.h"
+#include "intersection_check.h"
+#include "column_grid.h"
+#include "triple_buffer.h"
+#include "batch_queue.h"
+#include "pose_predictor.h"
+#include "compact_boxes.h"
+#include "compact_box_renderer.h"
+#include "tile_streamer.h"
+#include "heightfield_lod.h"
+#include "cone_picker.h"
+#include "frame_arena.h"
+#include "allocation_counter.h"
+#include "spatial_hash.h"
+#include "transform_publisher.h"
+#include "scene_replication.h"
+#include "startup_tracer.h"
+#include <fstream>
+#include <chrono>
+#include <future>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <algorithm>
+#include <limits>
+
+// different interaction states for the controllers
+enum InteractionState
+{
+	IS_NONE,
+	IS_OVER,
+	IS_GRAB
+};
+
+/// the plugin class natural_interfaces inherits like other plugins from node, drawable and provider
+class natural_interfaces :
+	public cgv::base::node,
+	public cgv::render::drawable,
+	public cgv::gui::event_handler,
+	public cgv::gui::provider
+{
+protected:
+	struct ray {
+		vec3 origin;
+		vec3 direction;
+	};
+
+	struct plane {
+		vec3 origin;
+		vec3 normal;
+	};
+
+	float offset;
+	vec3 hit_pos;
+
+	bool intersect(ray& r, plane& p, float& t) {
+
+		float denom = dot(r.direction, p.normal);
+
+		if (fabsf(denom) > std::numeric_limits<float>::epsilon()) {
+			vec3 diff = p.origin - r.origin;
+			t = dot(diff, p.normal) / denom;
+			return t >= 0.0f;
+		}
+
+		t = -1.0f;
+		return false;
+	}
+	
+	void move_box(int ci, const vec3& pos, float offset, const vec3& eye) {
+		ray mouse_ray;
+		mouse_ray.origin = eye;
+		mouse_ray.direction = normalize(pos - eye);
+		for (size_t i = 0; i < intersection_points.size(); ++i) {
+			if (intersection_controller_indices[i] != ci)
+				continue;
+			// extract box index
+			unsigned bi = intersection_box_indices[i];
+			movable_box_translations[bi] = pos + mouse_ray.direction *offset;
+			intersection_points[i] = pos + mouse_ray.direction *offset;
+			mark_box_changed(bi);
+
+		}
+		if (drop_preview)
+			update_drop_preview(ci);
+		post_scene_update();
+	}
+
+	// mouse ray variables
+	bool mouse_ray_activated;
+	// written by the interaction thread and read by event handling
+	std::atomic<bool> isGrab;
+	bool leftAct = false;
+	bool rightAct = false;
+
+	// store the scene as colored boxes
+	std::vector<box3> boxes;
+	std::vector<rgb> box_colors;
+
+	// rendering style for boxes
+	cgv::render::box_render_style style;
+
+	// whether environment boxes are kept in quantized form instead of boxes and box_colors
+	bool compact_static_boxes;
+	// quantized environment boxes used in compact mode
+	compact_box_array compact_boxes;
+	// grid over the quantized environment boxes
+	column_grid compact_grid;
+	// buffer reused to decode compact boxes for rendering if the compact box program is not available
+	std::vector<box3> decoded_boxes;
+	// whether movable boxes are drawn from quantized geometry and compact transforms of the predicted poses
+	bool compact_movable_boxes;
+	// quantized movable boxes in their local frame and the movable box index of each stored box and vice versa
+	compact_box_array movable_compact;
+	std::vector<unsigned> movable_compact_order, movable_compact_slots;
+	// compact transforms of the predicted poses in the order of movable_compact
+	std::vector<compact_transform> movable_compact_transforms;
+	// memory footprint of static and movable boxes in float and compact layout
+	float footprint_float_mb, footprint_compact_mb;
+
+	/// square tile of environment boxes that is generated or loaded in the background
+	struct environment_tile
+	{
+		int i, j;
+		std::vector<box3> boxes;
+		std::vector<rgb> colors;
+		// index of the box covering each cell or -1 for empty cells
+		std::vector<int> cell_boxes;
+		// bounds of all boxes of the tile
+		box3 bounds;
+		// one box per block of cells used in the far field
+		std::vector<box3> coarse_boxes;
+		std::vector<rgb> coarse_colors;
+		// gpu storage of the box and color arrays
+		cgv::render::attribute_array_manager aam;
+		// gpu storage of the coarse box and color arrays
+		cgv::render::attribute_array_manager coarse_aam;
+	};
+	// dimensions of the room, the environment is left out inside the room
+	float room_w, room_d, room_h;
+	// side length of environment cells
+	float environment_cell_size;
+	// number of static boxes not belonging to the environment
+	size_t nr_room_boxes;
+	// whether the environment is streamed in tiles around the viewer instead of being constructed up front
+	bool stream_environment;
+	// side length of the square region covered by the streamed environment
+	float world_size;
+	// number of cells along each side of a tile
+	unsigned tile_resolution;
+	// tiles closer than load radius are requested and tiles farther than evict radius are evicted
+	float load_radius, evict_radius;
+	// maximum number of tiles uploaded per frame
+	unsigned upload_budget;
+	// upper bound of the environment box heights
+	float environment_max_height;
+	// directory with pre-generated tiles named tile_<i>_<j>.bin, tiles not found there are generated
+	std::string tile_directory;
+	// streamer managing the environment tiles
+	tile_streamer<environment_tile> environment_streamer;
+	// whether resident tiles need to be released because streaming was switched off or restarted
+	bool tiles_outofdate;
+	// streaming statistics shown in the gui
+	unsigned tiles_resident, tiles_in_flight, tiles_evicted;
+
+	// whether environment blocks beyond lod_distance are drawn as single boxes of mean height
+	bool far_field_lod;
+	// distance from the viewer beyond which blocks are drawn coarse
+	float lod_distance;
+	// number of cells along each side of a far field block
+	unsigned lod_block_resolution;
+	// far field representation of the environment constructed up front, which orders the environment boxes by block
+	heightfield_lod environment_lod;
+	// ranges of static boxes and of coarse boxes drawn for the current viewer block
+	std::vector<heightfield_lod::range> lod_fine_ranges, lod_coarse_ranges;
+	// block containing the viewer when blocks were selected last
+	int lod_viewer_block[3];
+	// whether draw ranges have to be selected again although the viewer stayed in its block
+	bool lod_ranges_outofdate;
+	// number of static and environment boxes drawn in the last view
+	unsigned nr_drawn_boxes;
+	// temporary arrays of draw calls are allocated from this arena, which is reset at the start of each frame
+	frame_arena draw_arena;
+	// peak arena usage in bytes
+	unsigned arena_peak;
+	// heap allocations done during the last frame and total count at its start
+	unsigned frame_allocations;
+	size_t last_nr_allocations;
+
+	/// reset the frame arena and update allocation counters
+	void begin_frame_allocations()
+	{
+		draw_arena.reset();
+		if (arena_peak != (unsigned)draw_arena.get_peak()) {
+			arena_peak = (unsigned)draw_arena.get_peak();
+			update_member(&arena_peak);
+		}
+		size_t nr_allocations = allocation_counter::ref_nr_allocations();
+		if (frame_allocations != (unsigned)(nr_allocations - last_nr_allocations)) {
+			frame_allocations = (unsigned)(nr_allocations - last_nr_allocations);
+			update_member(&frame_allocations);
+		}
+		last_nr_allocations = nr_allocations;
+	}
+
+	// index of the current frame, advanced after the main render pass
+	unsigned frame_index;
+	// frame for which the view independent draw data was last prepared
+	unsigned prepared_frame;
+	// controller ray lines and label quad of the current frame, allocated from draw_arena
+	arena_vector<vec3> ray_positions;
+	arena_vector<rgb> ray_colors;
+	arena_vector<vec3> label_positions;
+	arena_vector<vec2> label_texcoords;
+	// gpu copies of the box arrays shared by all views of a frame
+	cgv::render::attribute_array_manager static_aam, lod_aam, compact_aam, movable_aam;
+	// renderers drawing quantized environment and movable boxes without decoding them on the cpu
+	compact_box_renderer compact_renderer, movable_compact_renderer;
+	// colors of movable boxes kept in a separate buffer such that single entries can be replaced
+	cgv::render::vertex_buffer movable_color_vbo;
+	// number of boxes drawn from static_aam and lod_aam
+	size_t nr_static_boxes;
+	// whether static or movable box geometry and colors need to be uploaded again
+	bool static_boxes_outofdate, movable_boxes_outofdate;
+	// whether compact boxes changed since they were uploaded
+	bool compact_boxes_outofdate;
+	// number of views drawn in the last frame and counter of the current frame
+	unsigned views_per_frame, nr_views;
+
+	/// compute view independent draw data once per frame such that all eyes and blit views reuse it
+	void prepare_frame(cgv::render::context& ctx)
+	{
+		if (prepared_frame == frame_index)
+			return;
+		prepared_frame = frame_index;
+		upload_mesh(ctx);
+		if (views_per_frame != nr_views) {
+			views_per_frame = nr_views;
+			update_member(&views_per_frame);
+		}
+		nr_views = 0;
+		// latch the most recent scene state published by the interaction thread for all views of this frame
+		scene_buffer.update();
+		begin_frame_allocations();
+		update_environment_tiles(ctx);
+		predict_grabbed_boxes();
+		prepare_rays();
+		prepare_label_quad();
+		upload_box_arrays(ctx);
+	}
+	/// collect line segments along the rays of tracked controllers
+	void prepare_rays()
+	{
+		// memory of the last frame was released by resetting the arena
+		ray_positions = arena_vector<vec3>(draw_arena);
+		ray_colors = arena_vector<rgb>(draw_arena);
+		const scene_state& S = scene_buffer.ref_front();
+		if (!vr_view_ptr)
+			return;
+		const vr::vr_kit_state* state_ptr = vr_view_ptr->get_current_vr_state();
+		if (!state_ptr)
+			return;
+		ray_positions.reserve(8);
+		ray_colors.reserve(8);
+		for (int ci = 0; ci < 4; ++ci) if (state_ptr->controller[ci].status == vr::VRS_TRACKED) {
+			vec3 ray_origin, ray_direction;
+			state_ptr->controller[ci].put_ray(&ray_origin(0), &ray_direction(0));
+			ray_positions.push_back(ray_origin);
+			ray_positions.push_back(ray_origin + ray_length * ray_direction);
+			rgb c(float(1 - ci), 0.5f * (int)S.controller_states[ci], float(ci));
+			ray_colors.push_back(c);
+			ray_colors.push_back(c);
+		}
+	}
+	/// compute corners of the label quad which faces the vr kit
+	void prepare_label_quad()
+	{
+		label_positions = arena_vector<vec3>(draw_arena);
+		label_texcoords = arena_vector<vec2>(draw_arena);
+		if (!vr_view_ptr)
+			return;
+		vec3 p(0, 1.5f, 0);
+		vec3 y = label_upright ? vec3(0, 1.0f, 0) : normalize(vr_view_ptr->get_view_up_dir_of_kit());
+		vec3 x = normalize(cross(vec3(vr_view_ptr->get_view_dir_of_kit()), y));
+		float w = 0.5f, h = 0.5f;
+		label_positions.reserve(4);
+		label_texcoords.reserve(4);
+		label_positions.push_back(p - 0.5f * w * x - 0.5f * h * y); label_texcoords.push_back(vec2(0.0f, 0.0f));
+		label_positions.push_back(p + 0.5f * w * x - 0.5f * h * y); label_texcoords.push_back(vec2(1.0f, 0.0f));
+		label_positions.push_back(p - 0.5f * w * x + 0.5f * h * y); label_texcoords.push_back(vec2(0.0f, 1.0f));
+		label_positions.push_back(p + 0.5f * w * x + 0.5f * h * y); label_texcoords.push_back(vec2(1.0f, 1.0f));
+	}
+	/// upload box arrays that changed since the last frame
+	void upload_box_arrays(cgv::render::context& ctx)
+	{
+		cgv::render::box_renderer& renderer = cgv::render::ref_box_renderer(ctx);
+		// static boxes are ordered by far field block and the coarse boxes live in their own buffer, so both are uploaded only
+		// when the environment changed and switching blocks between fine and coarse only changes the draw ranges
+		if (static_boxes_outofdate) {
+			renderer.enable_attribute_array_manager(ctx, static_aam);
+			renderer.set_box_array(ctx, boxes);
+			renderer.set_color_array(ctx, box_colors);
+			renderer.disable_attribute_array_manager(ctx, static_aam);
+			if (!environment_lod.get_coarse_boxes().empty()) {
+				renderer.enable_attribute_array_manager(ctx, lod_aam);
+				renderer.set_box_array(ctx, environment_lod.get_coarse_boxes());
+				renderer.set_color_array(ctx, environment_lod.get_coarse_colors());
+				renderer.disable_attribute_array_manager(ctx, lod_aam);
+			}
+			static_boxes_outofdate = false;
+			lod_ranges_outofdate = true;
+		}
+		bool lod = far_field_lod && !compact_static_boxes;
+		// blocks are selected again only when the viewer enters another block or the environment changed, which delays
+		// switching between fine and coarse by less than a block
+		int viewer_block[3] = { 0, 0, 0 };
+		vec3 viewer = get_viewer_position();
+		if (lod) {
+			float block_size = lod_block_resolution * environment_cell_size;
+			for (int j = 0; j < 3; ++j)
+				viewer_block[j] = (int)std::floor(viewer[j] / block_size);
+		}
+		if (lod_ranges_outofdate || !std::equal(viewer_block, viewer_block + 3, lod_viewer_block)) {
+			lod_fine_ranges.clear();
+			lod_coarse_ranges.clear();
+			// room boxes come first and are followed by the environment boxes in block order
+			heightfield_lod::append_range(lod_fine_ranges, 0, (unsigned)(lod ? nr_room_boxes : boxes.size()));
+			if (lod)
+				environment_lod.select(viewer, lod_distance, (unsigned)nr_room_boxes, lod_fine_ranges, lod_coarse_ranges);
+			nr_static_boxes = 0;
+			for (const auto& r : lod_fine_ranges)
+				nr_static_boxes += r.count;
+			for (const auto& r : lod_coarse_ranges)
+				nr_static_boxes += r.count;
+			std::copy(viewer_block, viewer_block + 3, lod_viewer_block);
+			lod_ranges_outofdate = false;
+		}
+		// compact boxes are uploaded only when they were rebuilt, all other frames draw the cached upload
+		if (compact_boxes_outofdate) {
+			if (compact_static_boxes && !compact_boxes.empty() && compact_renderer.is_initialized())
+				compact_renderer.set_boxes(compact_boxes);
+			else if (compact_static_boxes && !compact_boxes.empty()) {
+				// without the compact box program geometry is decoded for the upload while colors are uploaded as normalized bytes
+				compact_boxes.decode_boxes(decoded_boxes);
+				renderer.enable_attribute_array_manager(ctx, compact_aam);
+				renderer.set_box_array(ctx, decoded_boxes);
+				renderer.set_color_array(ctx, compact_boxes.get_colors());
+				renderer.disable_attribute_array_manager(ctx, compact_aam);
+				std::vector<box3>().swap(decoded_boxes);
+			}
+			compact_boxes_outofdate = false;
+		}
+		if (compact_movable_boxes && movable_compact_renderer.is_initialized()) {
+			if (movable_boxes_outofdate) {
+				movable_compact.build(movable_boxes.data(), movable_box_colors.data(), movable_boxes.size(), 16.0f, &movable_compact_order);
+				movable_compact_slots.resize(movable_compact_order.size());
+				for (unsigned e = 0; e < movable_compact_order.size(); ++e)
+					movable_compact_slots[movable_compact_order[e]] = e;
+				movable_compact_renderer.set_boxes(movable_compact);
+				highlighted_box = -1;
+				movable_boxes_outofdate = false;
+			}
+			// predicted poses are quantized like replicated transforms, which reduces the per frame upload from 28 to 12 bytes per box
+			movable_compact_transforms.resize(movable_compact_order.size());
+			for (unsigned e = 0; e < movable_compact_order.size(); ++e) {
+				unsigned bi = movable_compact_order[e];
+				movable_compact_transforms[e] = pack_transform(predicted_translations[bi], predicted_rotations[bi], get_replication_region_min(), get_replication_region_size());
+			}
+			movable_compact_renderer.set_transforms(movable_compact_transforms, get_replication_region_min(), get_replication_region_size());
+			update_highlight(ctx);
+			return;
+		}
+		renderer.enable_attribute_array_manager(ctx, movable_aam);
+		if (movable_boxes_outofdate) {
+			renderer.set_box_array(ctx, movable_boxes);
+			movable_color_vbo.destruct(ctx);
+			movable_color_vbo.create(ctx, movable_box_colors);
+			renderer.set_color_array(ctx, cgv::render::element_descriptor_traits<rgb>::get_type_descriptor(rgb()),
+				movable_color_vbo, 0, movable_box_colors.size());
+			highlighted_box = -1;
+			movable_boxes_outofdate = false;
+		}
+		renderer.set_translation_array(ctx, predicted_translations);
+		renderer.set_rotation_array(ctx, predicted_rotations);
+		renderer.disable_attribute_array_manager(ctx, movable_aam);
+		update_highlight(ctx);
+	}
+	/// replace the color entries of the previously and the currently hovered box
+	void update_highlight(cgv::render::context& ctx)
+	{
+		int bi = hover_highlight ? scene_buffer.ref_front().hovered_box : -1;
+		if (bi == highlighted_box)
+			return;
+		bool compact = compact_movable_boxes && movable_compact_renderer.is_initialized();
+		auto replace_color = [&](int bi, const rgb& c) {
+			if (compact)
+				movable_compact_renderer.replace_color(movable_compact_slots[bi], compact_box_array::quantize_color(c));
+			else
+				movable_color_vbo.replace(ctx, bi * sizeof(rgb), &c, 1);
+		};
+		if (highlighted_box != -1 && highlighted_box < (int)movable_box_colors.size())
+			replace_color(highlighted_box, movable_box_colors[highlighted_box]);
+		if (bi != -1) {
+			const rgb& c = movable_box_colors[bi];
+			replace_color(bi, rgb(0.5f * c[0] + 0.5f, 0.5f * c[1] + 0.5f, 0.5f * c[2] + 0.5f));
+		}
+		highlighted_box = bi;
+	}
+
+	/// return bounds of the room and the table, whose footprint is never covered by far field blocks
+	box3 get_room_bounds() const
+	{
+		box3 bounds;
+		for (size_t bi = 0; bi < nr_room_boxes; ++bi) {
+			bounds.add_point(boxes[bi].get_min_pnt());
+			bounds.add_point(boxes[bi].get_max_pnt());
+		}
+		return bounds;
+	}
+	/// rebuild far field blocks of the environment constructed up front
+	void build_environment_lod()
+	{
+		box3 room_bounds = get_room_bounds();
+		environment_lod.build(boxes.data() + nr_room_boxes, box_colors.data() + nr_room_boxes,
+			boxes.size() - nr_room_boxes, lod_block_resolution * environment_cell_size, &room_bounds);
+		static_boxes_outofdate = true;
+	}
+
+	// return position of the hmd if tracked or of the desktop camera otherwise
+	vec3 get_viewer_position()
+	{
+		if (vr_view_ptr) {
+			const vr::vr_kit_state* state_ptr = vr_view_ptr->get_current_vr_state();
+			if (state_ptr && state_ptr->hmd.status == vr::VRS_TRACKED)
+				return vec3(state_ptr->hmd.pose[9], state_ptr->hmd.pose[10], state_ptr->hmd.pose[11]);
+		}
+		auto view_ptr = find_view_as_node();
+		if (view_ptr)
+			return view_ptr->get_eye();
+		return vec3(0.0f);
+	}
+	/// switch between constructing the environment up front and streaming it in tiles
+	void set_stream_environment(bool stream)
+	{
+		bool compact = compact_static_boxes;
+		if (compact)
+			set_compact_static_boxes(false);
+		boxes.resize(nr_room_boxes);
+		box_colors.resize(nr_room_boxes);
+		// resident tiles are released in init_frame where the context is available
+		tiles_outofdate = true;
+		if (stream) {
+			// worker threads get their own copy of the generation parameters
+			float s = environment_cell_size, tile_size = tile_resolution * s;
+			float w = room_w, d = room_d, max_height = environment_max_height;
+			unsigned n = tile_resolution;
+			float block_size = lod_block_resolution * s;
+			box3 room_bounds = get_room_bounds();
+			std::string dir = tile_directory;
+			environment_streamer.start(2, tile_size, 0.5f * world_size, [=](environment_tile& t) {
+				if (dir.empty() || !read_environment_tile(dir, n, t))
+					construct_environment_tile(t, s, n, w, d, max_height);
+				heightfield_lod lod;
+				lod.build(t.boxes.data(), t.colors.data(), t.boxes.size(), block_size, &room_bounds);
+				t.coarse_boxes = lod.get_coarse_boxes();
+				t.coarse_colors = lod.get_coarse_colors();
+				for (const box3& b : t.boxes) {
+					t.bounds.add_point(b.get_min_pnt());
+					t.bounds.add_point(b.get_max_pnt());
+				}
+			});
+		}
+		else {
+			environment_streamer.stop();
+			construct_environment(environment_cell_size, 3 * room_w, 3 * room_d, room_h, room_w, room_d, room_h);
+		}
+		build_environment_lod();
+		if (compact)
+			set_compact_static_boxes(true);
+		else
+			static_grid.build(boxes, 0.25f);
+	}
+	/// request, upload and evict environment tiles according to the current viewer position
+	void update_environment_tiles(cgv::render::context& ctx)
+	{
+		if (!stream_environment && !tiles_outofdate)
+			return;
+		// the interaction thread looks up resident tiles when dropping boxes, so tiles only change while it is idle
+		std::unique_lock<std::mutex> lock(interaction_mutex, std::try_to_lock);
+		if (!lock.owns_lock()) {
+			post_redraw();
+			return;
+		}
+		auto evict = [&ctx](environment_tile& t) {
+			t.aam.destruct(ctx);
+			t.coarse_aam.destruct(ctx);
+		};
+		if (tiles_outofdate) {
+			environment_streamer.clear(evict);
+			tiles_outofdate = false;
+		}
+		if (stream_environment) {
+			vec3 viewer = get_viewer_position();
+			environment_streamer.update(viewer[0], viewer[2], load_radius, evict_radius, evict);
+			cgv::render::box_renderer& renderer = cgv::render::ref_box_renderer(ctx);
+			environment_streamer.upload(upload_budget, [&](environment_tile& t) {
+				t.aam.init(ctx);
+				renderer.enable_attribute_array_manager(ctx, t.aam);
+				renderer.set_box_array(ctx, t.boxes);
+				renderer.set_color_array(ctx, t.colors);
+				renderer.disable_attribute_array_manager(ctx, t.aam);
+				t.coarse_aam.init(ctx);
+				renderer.enable_attribute_array_manager(ctx, t.coarse_aam);
+				renderer.set_box_array(ctx, t.coarse_boxes);
+				renderer.set_color_array(ctx, t.coarse_colors);
+				renderer.disable_attribute_array_manager(ctx, t.coarse_aam);
+			});
+		}
+		auto stats = environment_streamer.get_statistics();
+		if (stats.resident != tiles_resident || stats.in_flight != tiles_in_flight || stats.evicted != tiles_evicted) {
+			tiles_resident = stats.resident;
+			tiles_in_flight = stats.in_flight;
+			tiles_evicted = stats.evicted;
+			update_member(&tiles_resident);
+			update_member(&tiles_in_flight);
+			update_member(&tiles_evicted);
+		}
+		// keep frames coming until all requested tiles arrived
+		if (stats.in_flight > 0)
+			post_redraw();
+	}
+
+
+	// sample for rendering a mesh
+	double mesh_scale;
+	dvec3 mesh_location;
+	dquat mesh_orientation;
+
+	// render information for mesh
+	cgv::render::mesh_render_info MI;
+	// mesh read by a background thread and uploaded in the first frame in which it is ready
+	cgv::media::mesh::simple_mesh<> loaded_mesh;
+	std::future<bool> mesh_loading;
+
+
+	// sample for rendering text labels
+	std::string label_text;
+	int label_font_idx;
+	bool label_upright;
+	float label_size;
+	rgb label_color;
+
+	std::atomic<bool> label_outofdate; // whether label texture is out of date
+	unsigned label_resolution; // resolution of label texture
+	cgv::render::texture label_tex; // texture used for offline rendering of label
+	cgv::render::frame_buffer label_fbo; // fbo used for offline rendering of label
+
+	// general font information, enumerated only once the label gui needs it
+	std::vector<const char*> font_names;
+	std::string font_enum_decl;
+
+	// current font face used, looked up when the label is rendered the first time
+	std::string label_font_name;
+	cgv::media::font::font_face_ptr label_font_face;
+	cgv::media::font::FontFaceAttributes label_face_type;
+
+	// time from plugin construction to the end of the first frame
+	double time_to_first_frame_ms;
+
+	/// enumerate installed fonts and build the enum declaration of the font dropdown
+	void ensure_fonts()
+	{
+		if (!font_names.empty())
+			return;
+		startup_tracer::scope trace(ref_startup_tracer(), "enumerate fonts");
+		cgv::media::font::enumerate_font_names(font_names);
+		font_enum_decl = "enums='";
+		for (unsigned i = 0; i < font_names.size(); ++i) {
+			if (i > 0)
+				font_enum_decl += ";";
+			std::string fn(font_names[i]);
+			if (cgv::utils::to_lower(fn) == cgv::utils::to_lower(label_font_name))
+				label_font_idx = i;
+			font_enum_decl += fn;
+		}
+		font_enum_decl += "'";
+	}
+	/// look up the face of the label font if it is not known yet, falling back to the first installed font
+	void ensure_label_font()
+	{
+		if (!label_font_face.empty())
+			return;
+		startup_tracer::scope trace(ref_startup_tracer(), "find label font");
+		cgv::media::font::font_ptr font = cgv::media::font::find_font(label_font_name);
+		if (font.empty()) {
+			ensure_fonts();
+			if (font_names.empty())
+				return;
+			label_font_idx = 0;
+			label_font_name = font_names[0];
+			font = cgv::media::font::find_font(label_font_name);
+			if (font.empty())
+				return;
+		}
+		label_font_face = font->get_font_face(label_face_type);
+	}
+	/// upload the mesh once the background thread finished reading it
+	void upload_mesh(cgv::render::context& ctx)
+	{
+		if (!mesh_loading.valid() || mesh_loading.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+			return;
+		if (mesh_loading.get()) {
+			startup_tracer::scope trace(ref_startup_tracer(), "upload mesh");
+			MI.construct(ctx, loaded_mesh);
+			MI.bind(ctx, ctx.ref_surface_shader_program(true), true);
+		}
+		loaded_mesh.clear();
+	}
+
+
+	// keep deadzone and precision vector for left controller
+	cgv::gui::vr_server::vec_flt_flt left_deadzone_and_precision;
+	// store handle to vr kit of which left deadzone and precision is configured
+	void* last_kit_handle;
+
+	// length of to be rendered rays
+	float ray_length;
+
+	// keep reference to vr_view_interactor
+	vr_view_interactor* vr_view_ptr;
+
+	// store the movable boxes
+	std::vector<box3> movable_boxes;
+	std::vector<rgb> movable_box_colors;
+	std::vector<vec3> movable_box_translations;
+	std::vector<quat> movable_box_rotations;
+
+	// intersection points
+	std::vector<vec3> intersection_points;
+	std::vector<rgb>  intersection_colors;
+	std::vector<int>  intersection_box_indices;
+	std::vector<int>  intersection_controller_indices;
+
+	// state of current interaction with boxes for each controller
+	InteractionState state[4];
+
+	// whether picking selects the single best box within a cone around the ray instead of all boxes hit by the ray
+	bool cone_picking;
+	// half opening angle of the picking cone in degrees
+	float cone_angle;
+	// weight of the hit distance relative to the angular distance when choosing among boxes in the cone
+	float cone_depth_weight;
+	// ray packet and cone used for picking
+	cone_picker picker;
+	// duration of the last cone pick and number of boxes tested with the ray packet
+	float cone_time_us;
+	unsigned cone_candidates;
+
+	// whether vr controllers select the boxes they touch before falling back to their rays
+	bool touch_grab;
+	// radius of the sphere around the controller position used for touching
+	float touch_radius;
+	// hash of the bounding spheres of movable boxes
+	spatial_hash movable_hash;
+	// duration of the last touch query and number of boxes tested exactly
+	float touch_time_us;
+	unsigned touch_candidates;
+
+	/// enter movable box bi into the spatial hash or move it to its current location
+	void update_movable_hash(unsigned bi)
+	{
+		movable_hash.update(bi, movable_box_translations[bi] + movable_box_rotations[bi].apply(movable_boxes[bi].get_center()),
+			0.5f * movable_boxes[bi].get_extent().length());
+	}
+	/// rebuild the spatial hash from all movable boxes with a cell size matching the largest box
+	void build_movable_hash()
+	{
+		float cell_size = 0.01f;
+		for (const box3& B : movable_boxes)
+			cell_size = std::max(cell_size, B.get_extent().length());
+		movable_hash.clear(cell_size);
+		for (unsigned bi = 0; bi < movable_boxes.size(); ++bi)
+			update_movable_hash(bi);
+	}
+	/// add an intersection for each movable box touched by the sphere around p and return whether any was found
+	bool compute_touch_intersections(const vec3& p, int ci, const rgb& color)
+	{
+		auto start = std::chrono::high_resolution_clock::now();
+		bool found = false;
+		touch_candidates = 0;
+		movable_hash.query(p, touch_radius, [&](unsigned bi) {
+			++touch_candidates;
+			// closest point of the box to the sphere center in box coordinates
+			vec3 q = p - movable_box_translations[bi];
+			movable_box_rotations[bi].inverse_rotate(q);
+			const box3& B = movable_boxes[bi];
+			vec3 c;
+			for (int j = 0; j < 3; ++j)
+				c[j] = std::max(B.get_min_pnt()[j], std::min(B.get_max_pnt()[j], q[j]));
+			if ((c - q).sqr_length() > touch_radius * touch_radius)
+				return;
+			movable_box_rotations[bi].rotate(c);
+			intersection_points.push_back(c + movable_box_translations[bi]);
+			intersection_colors.push_back(color);
+			intersection_box_indices.push_back((int)bi);
+			intersection_controller_indices.push_back(ci);
+			found = true;
+		});
+		touch_time_us = std::chrono::duration<float, std::micro>(std::chrono::high_resolution_clock::now() - start).count();
+		return found;
+	}
+
+	// whether the movable box under the mouse cursor is highlighted
+	bool hover_highlight;
+	// movable box under the mouse cursor or -1
+	int hovered_box;
+	// movable box whose color is highlighted on the gpu or -1
+	int highlighted_box;
+	// number of hover queries bounded by a hit of the previously hovered box and without such a bound
+	unsigned hover_bounded_queries, hover_unbounded_queries;
+	// number of boxes tested exactly in the last hover query
+	unsigned hover_tests;
+
+	/// intersect ray with movable box bi and return ray parameter of the hit
+	bool intersect_movable_box(unsigned bi, const vec3& origin, const vec3& direction, float& t) const
+	{
+		vec3 origin_box = origin - movable_box_translations[bi];
+		movable_box_rotations[bi].inverse_rotate(origin_box);
+		vec3 direction_box = direction;
+		movable_box_rotations[bi].inverse_rotate(direction_box);
+		vec3 p, n;
+		return cgv::media::ray_axis_aligned_box_intersection(origin_box, direction_box, movable_boxes[bi], t, p, n, 0.000001f);
+	}
+	/// find hovered box by walking the spatial hash along the ray, where a hit of the previously hovered box bounds the walk
+	void update_hover(const vec3& origin, const vec3& direction)
+	{
+		int bi = -1;
+		float t_max = std::numeric_limits<float>::infinity(), t;
+		if (hovered_box != -1 && hovered_box < (int)movable_boxes.size() &&
+			intersect_movable_box(hovered_box, origin, direction, t)) {
+			bi = hovered_box;
+			t_max = t;
+			++hover_bounded_queries;
+		}
+		else
+			++hover_unbounded_queries;
+		// any box in front of the bound is still found
+		hover_tests = 0;
+		movable_hash.query_ray(origin, direction, t_max, [&](unsigned i) {
+			if ((int)i == hovered_box)
+				return;
+			++hover_tests;
+			if (intersect_movable_box(i, origin, direction, t) && t < t_max) {
+				bi = i;
+				t_max = t;
+			}
+		});
+		if (bi == hovered_box)
+			return;
+		hovered_box = bi;
+		readouts_outofdate = true;
+		post_scene_update();
+	}
+
+	// render style for interaction
+	cgv::render::sphere_render_style srs;
+	cgv::render::box_render_style movable_style;
+
+	// whether released boxes are dropped onto the surface below them
+	bool drop_to_surface;
+	// whether the landing pose of grabbed boxes is previewed during drags
+	bool drop_preview;
+	// grid over the static boxes used to accelerate downward ray casts
+	column_grid static_grid;
+	// landing poses of the grabbed boxes shown as preview
+	std::vector<box3> preview_boxes;
+	std::vector<rgb> preview_colors;
+	std::vector<vec3> preview_translations;
+	std::vector<quat> preview_rotations;
+	// duration of the last drop query in microseconds
+	float drop_time_us;
+	// reused list of boxes grabbed by a controller
+	std::vector<unsigned> grabbed_box_indices;
+
+	/// snapshot of the scene state modified by interaction and read by rendering
+	struct scene_state
+	{
+		std::vector<vec3> movable_box_translations;
+		std::vector<quat> movable_box_rotations;
+		std::vector<vec3> intersection_points;
+		std::vector<rgb>  intersection_colors;
+		std::vector<int>  intersection_box_indices;
+		std::vector<int>  intersection_controller_indices;
+		std::vector<box3> preview_boxes;
+		std::vector<rgb>  preview_colors;
+		std::vector<vec3> preview_translations;
+		std::vector<quat> preview_rotations;
+		InteractionState controller_states[4];
+		pose_history controller_histories[4];
+		int hovered_box;
+		scene_state() : hovered_box(-1) { std::fill(controller_states, controller_states + 4, IS_NONE); }
+	};
+	// snapshots of the interaction state, which the interaction thread publishes once per batch of events and the gui thread latches at
+	// the start of each frame, such that drawing never waits for interaction or reads half updated state
+	triple_buffer<scene_state> scene_buffer;
+	// movable boxes changed since each snapshot buffer was filled last
+	triple_buffer_changes scene_changes;
+	// whether the scene changed since the last published snapshot
+	bool scene_update_pending;
+	// movable boxes changed since the last published snapshot, each listed once
+	std::vector<unsigned> changed_boxes;
+	std::vector<bool> changed_box_listed;
+	// whether transforms of movable boxes are published to shared memory for other processes
+	bool share_transforms;
+	// name of the shared memory segment, read with transform_reader.h
+	std::string shared_memory_name;
+	// writer of the shared memory segment
+	transform_publisher publisher;
+	// number of transforms written in the last publication
+	unsigned published_changes;
+	// whether growing the segment failed, which is reported once until sharing is enabled again
+	bool publisher_grow_failed;
+
+	/// create or remove the shared memory segment
+	void set_share_transforms(bool share)
+	{
+		publisher.close();
+		publisher_grow_failed = false;
+		if (!share)
+			return;
+		// twice the current number of boxes leaves room to add boxes before the segment has to grow
+		if (!publisher.open(shared_memory_name, (uint32_t)std::max(2 * movable_boxes.size(), size_t(1)), 4096)) {
+			std::cerr << "could not create shared memory " << shared_memory_name << std::endl;
+			share_transforms = false;
+			update_member(&share_transforms);
+			return;
+		}
+		publisher.publish(movable_box_translations.data(), movable_box_rotations.data(), movable_box_translations.size());
+	}
+	// whether movable boxes are shared with other instances through the relay
+	bool replicate;
+	// whether this instance hosts the relay, which is skipped if another instance already hosts it
+	bool host_relay;
+	// port on which the relay listens
+	unsigned relay_port;
+	replication_relay relay;
+	// exchanges changes with the relay on its own thread, remote changes are applied when the scene update is flushed
+	replication_channel replication;
+	// bandwidth in kB/s, round trip time and latency of remote changes, updated once per second
+	float replication_out_kbps, replication_in_kbps, replication_rtt_ms, replication_latency_ms;
+	double last_replication_report;
+	replication_statistics last_replication_statistics;
+	// number of clients, changed boxes per client and frame and duration of the replication test
+	unsigned test_clients, test_churn;
+	float test_seconds;
+	// replication test running in the background
+	std::future<void> replication_test;
+
+	/// return corner of the cube in which translations are quantized for replication
+	static vec3 get_replication_region_min() { return vec3(-16.0f); }
+	/// return side length of the cube in which translations are quantized for replication
+	static float get_replication_region_size() { return 32.0f; }
+	/// return quantized transforms of all movable boxes
+	std::vector<compact_transform> pack_movable_transforms() const
+	{
+		std::vector<compact_transform> transforms(movable_boxes.size());
+		for (size_t i = 0; i < movable_boxes.size(); ++i)
+			transforms[i] = pack_transform(movable_box_translations[i], movable_box_rotations[i], get_replication_region_min(), get_replication_region_size());
+		return transforms;
+	}
+	/// connect to the relay and host it if requested
+	void set_replicate(bool on)
+	{
+		replication.stop();
+		relay.stop();
+		if (!on)
+			return;
+		if (host_relay && !relay.start((uint16_t)relay_port))
+			std::cout << "relay port " << relay_port << " in use, joining existing relay" << std::endl;
+		if (!replication.start((uint16_t)relay_port, pack_movable_transforms())) {
+			std::cerr << "could not connect to relay on port " << relay_port << std::endl;
+			replicate = false;
+			update_member(&replicate);
+			return;
+		}
+		last_replication_report = get_time();
+		last_replication_statistics = replication.get_statistics();
+	}
+	/// hand the local changes of movable boxes to the replication thread and apply the changes of other instances received by it
+	void replicate_scene()
+	{
+		if (!replication.is_running())
+			return;
+		vec3 region_min = get_replication_region_min();
+		float region_size = get_replication_region_size();
+		// boxes marked by events since the last flush are local changes, remote changes are marked below and published with them
+		if (scene_update_pending)
+			for (unsigned bi : changed_boxes)
+				replication.submit(bi, pack_transform(movable_box_translations[bi], movable_box_rotations[bi], region_min, region_size));
+		size_t n = movable_boxes.size();
+		size_t nr_remote = replication.poll([&](uint32_t i, const compact_transform& c) {
+			if (i >= n)
+				return;
+			unpack_transform(c, region_min, region_size, movable_box_translations[i], movable_box_rotations[i]);
+			mark_box_changed(i);
+		});
+		if (nr_remote > 0)
+			scene_update_pending = true;
+	}
+	/// update bandwidth and latency readouts of the replication once per second
+	void update_replication_readouts()
+	{
+		if (!replication.is_running())
+			return;
+		double now = get_time();
+		if (now - last_replication_report < 1.0)
+			return;
+		replication_statistics s = replication.get_statistics();
+		float seconds = float(now - last_replication_report);
+		replication_out_kbps = (s.bytes_sent - last_replication_statistics.bytes_sent) / (1024.0f * seconds);
+		replication_in_kbps = (s.bytes_received - last_replication_statistics.bytes_received) / (1024.0f * seconds);
+		replication_rtt_ms = (float)s.round_trip_ms;
+		replication_latency_ms = (float)s.latency_ms;
+		update_member(&replication_out_kbps);
+		update_member(&replication_in_kbps);
+		update_member(&replication_rtt_ms);
+		update_member(&replication_latency_ms);
+		last_replication_report = now;
+		last_replication_statistics = s;
+	}
+	/// hand results of the interaction thread to the gui thread, which alone requests redraws and updates gui controls
+	void timer_event(double, double)
+	{
+		if (redraw_requested.exchange(false))
+			post_redraw();
+		// readouts change with every pose event, so like the latency readouts they are shown at most four times per second and the
+		// flag stays set until then such that the last values are shown
+		double now = get_time();
+		if (now - last_interaction_readout_time > 0.25 && readouts_outofdate.exchange(false)) {
+			last_interaction_readout_time = now;
+			update_member(&cone_time_us);
+			update_member(&cone_candidates);
+			update_member(&touch_time_us);
+			update_member(&touch_candidates);
+			update_member(&hover_bounded_queries);
+			update_member(&hover_unbounded_queries);
+			update_member(&hover_tests);
+			update_member(&drop_time_us);
+			update_member(&published_changes);
+		}
+		update_replication_readouts();
+	}
+	/// run a private relay with nr_clients clients that each change churn random boxes per frame at 90 Hz and report bandwidth, latency and convergence
+	static void run_replication_test(std::vector<compact_transform> initial, unsigned nr_clients, unsigned churn, float duration)
+	{
+		replication_relay test_relay;
+		if (!test_relay.start(0)) {
+			std::cerr << "could not start test relay" << std::endl;
+			return;
+		}
+		if (initial.empty())
+			initial.resize(1);
+		size_t n = initial.size();
+		std::vector<replication_client> clients(nr_clients);
+		std::vector<std::vector<compact_transform> > tables(nr_clients, initial);
+		for (auto& c : clients) {
+			c.connect(test_relay.get_port());
+			c.mark_all_changed(uint32_t(n));
+		}
+		std::default_random_engine generator(1);
+		std::uniform_int_distribution<size_t> box_distribution(0, n - 1);
+		std::uniform_int_distribution<uint32_t> value_distribution(0, 0xffffffff);
+		// churn is followed by half a second without changes to let all clients converge
+		unsigned nr_churn_frames = unsigned(90 * duration), nr_frames = nr_churn_frames + 45;
+		double start = get_time();
+		for (unsigned f = 0; f < nr_frames; ++f) {
+			for (unsigned ci = 0; ci < nr_clients; ++ci) {
+				if (f < nr_churn_frames)
+					for (unsigned k = 0; k < churn; ++k) {
+						size_t i = box_distribution(generator);
+						compact_transform& c = tables[ci][i];
+						c.translation[0] = uint16_t(value_distribution(generator));
+						c.rotation = value_distribution(generator);
+						clients[ci].mark_changed(uint32_t(i));
+					}
+				clients[ci].send(tables[ci]);
+				clients[ci].receive([&](uint32_t i, const compact_transform& c) {
+					if (i < n)
+						tables[ci][i] = c;
+				});
+			}
+			std::this_thread::sleep_until(std::chrono::steady_clock::now() + std::chrono::microseconds(11111));
+		}
+		double seconds = get_time() - start;
+		size_t nr_mismatches = 0;
+		for (unsigned ci = 1; ci < nr_clients; ++ci)
+			for (size_t i = 0; i < n; ++i)
+				if (tables[ci][i] != tables[0][i])
+					++nr_mismatches;
+		for (unsigned ci = 0; ci < nr_clients; ++ci) {
+			const replication_statistics& s = clients[ci].get_statistics();
+			std::cout << "client " << ci << ": out " << s.bytes_sent / (1024.0 * seconds) << " kB/s, in "
+				<< s.bytes_received / (1024.0 * seconds) << " kB/s, " << s.entries_sent << " entries sent, "
+				<< s.entries_received << " received, round trip " << s.round_trip_ms << " ms, latency " << s.latency_ms << " ms" << std::endl;
+		}
+		std::cout << nr_clients << " clients, " << churn << " changes per frame: "
+			<< nr_mismatches << " boxes differ after convergence" << std::endl;
+	}
+	/// start the replication test in the background on the current transforms of the movable boxes
+	void test_replication()
+	{
+		if (replication_test.valid() && replication_test.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+			std::cout << "replication test is still running" << std::endl;
+			return;
+		}
+		std::vector<compact_transform> initial;
+		{
+			std::lock_guard<std::mutex> lock(interaction_mutex);
+			initial = pack_movable_transforms();
+		}
+		replication_test = std::async(std::launch::async, &natural_interfaces::run_replication_test, initial,
+			test_clients, test_churn, test_seconds);
+	}
+	/// copy the current scene state into the back buffer and publish it
+	void publish_scene_state()
+	{
+		if (publisher.is_open()) {
+			// the larger segment gets the next generation name, which readers find in the header of the old one
+			if (movable_box_translations.size() > publisher.get_capacity() && !publisher_grow_failed &&
+				!publisher.grow((uint32_t)(2 * movable_box_translations.size()))) {
+				std::cerr << "could not grow shared memory " << shared_memory_name << ", transforms beyond " << publisher.get_capacity() << " are not shared" << std::endl;
+				publisher_grow_failed = true;
+			}
+			unsigned nr_changed = (unsigned)publisher.publish_changes(movable_box_translations.data(), movable_box_rotations.data(),
+				movable_box_translations.size(), changed_boxes);
+			if (nr_changed != published_changes) {
+				published_changes = nr_changed;
+				readouts_outofdate = true;
+			}
+		}
+		// transforms of movable boxes are the only large arrays, so only the boxes changed since this buffer was filled are copied
+		scene_state& S = scene_buffer.ref_back();
+		if (S.movable_box_translations.size() != movable_box_translations.size()) {
+			S.movable_box_translations = movable_box_translations;
+			S.movable_box_rotations = movable_box_rotations;
+		}
+		scene_changes.apply(scene_buffer.get_back_index(), [&](unsigned bi) {
+			S.movable_box_translations[bi] = movable_box_translations[bi];
+			S.movable_box_rotations[bi] = movable_box_rotations[bi];
+		});
+		S.intersection_points = intersection_points;
+		S.intersection_colors = intersection_colors;
+		S.intersection_box_indices = intersection_box_indices;
+		S.intersection_controller_indices = intersection_controller_indices;
+		S.preview_boxes = preview_boxes;
+		S.preview_colors = preview_colors;
+		S.preview_translations = preview_translations;
+		S.preview_rotations = preview_rotations;
+		S.hovered_box = hovered_box;
+		for (int ci = 0; ci < 4; ++ci) {
+			S.controller_states[ci] = state[ci];
+			S.controller_histories[ci] = pose_histories[ci];
+		}
+		scene_buffer.publish();
+		for (unsigned bi : changed_boxes)
+			changed_box_listed[bi] = false;
+		changed_boxes.clear();
+	}
+	/// move movable box bi in the spatial hash and mark its transform for the next snapshot
+	void mark_box_changed(unsigned bi)
+	{
+		update_movable_hash(bi);
+		scene_changes.mark(bi);
+		if (bi >= changed_box_listed.size())
+			changed_box_listed.resize(bi + 1, false);
+		if (!changed_box_listed[bi]) {
+			changed_box_listed[bi] = true;
+			changed_boxes.push_back(bi);
+		}
+	}
+	/// request publication of the scene state after the current batch of events
+	void post_scene_update()
+	{
+		scene_update_pending = true;
+	}
+	/// publish the scene state once for all events of a batch and ask the gui thread for a redraw
+	void flush_scene_update()
+	{
+		if (!scene_update_pending)
+			return;
+		publish_scene_state();
+		scene_update_pending = false;
+		redraw_requested = true;
+	}
+
+	/// kinds of input handed from event handling to the interaction thread
+	enum InteractionEventKind
+	{
+		IE_POSE,
+		IE_STICK_TOUCH,
+		IE_STICK_RELEASE,
+		IE_MOUSE_PRESS,
+		IE_MOUSE_RELEASE,
+		IE_MOUSE_MOVE,
+		IE_MOUSE_DRAG,
+		IE_MOUSE_WHEEL
+	};
+	/// input recorded by event handling, which is all the interaction thread needs to process it without the view or the context
+	struct interaction_event
+	{
+		InteractionEventKind kind;
+		// controller index, 0 for the mouse
+		int ci;
+		// time at which a pose was received
+		double time;
+		// ray of the controller or through the mouse cursor starting at the eye
+		vec3 origin, direction;
+		// current and previous controller position, current orientation and rotation from the previous to the current orientation
+		vec3 position, last_position;
+		quat orientation;
+		mat3 rotation;
+		// focus of the view, which the drag plane of the mouse passes through
+		vec3 focus;
+		// whether the left mouse button was pressed and mouse motion since the last event
+		bool left;
+		float dx, dy;
+	};
+	// input waiting for the interaction thread
+	batch_queue<interaction_event> interaction_events;
+	// thread that picks, touches, moves and drops boxes and publishes the scene state
+	std::thread interaction_thread;
+	// held by the interaction thread while it processes a batch and by the gui thread while it changes data used by interaction
+	std::mutex interaction_mutex;
+	// set by the interaction thread when a snapshot was published or readouts changed and cleared by the gui thread in timer_event
+	std::atomic<bool> redraw_requested, readouts_outofdate;
+	// time of last update of the readouts of the interaction thread
+	double last_interaction_readout_time;
+
+	/// start the interaction thread unless it is running
+	void start_interaction()
+	{
+		if (interaction_thread.joinable())
+			return;
+		interaction_events.restart();
+		interaction_thread = std::thread(&natural_interfaces::run_interaction, this);
+	}
+	/// stop the interaction thread and wait for it
+	void stop_interaction()
+	{
+		interaction_events.stop();
+		if (interaction_thread.joinable())
+			interaction_thread.join();
+	}
+	/// process batches of input and publish one snapshot per batch, remote changes of the replication are applied in between
+	void run_interaction()
+	{
+		std::vector<interaction_event> batch;
+		while (interaction_events.wait_and_take(batch, std::chrono::milliseconds(replication.is_running() ? 2 : 50))) {
+			{
+				std::lock_guard<std::mutex> lock(interaction_mutex);
+				for (const interaction_event& ie : batch)
+					process_interaction_event(ie);
+				replicate_scene();
+				flush_scene_update();
+			}
+			batch.clear();
+		}
+	}
+	/// apply a single input to the interaction state
+	void process_interaction_event(const interaction_event& ie)
+	{
+		int ci = ie.ci;
+		switch (ie.kind) {
+		case IE_MOUSE_PRESS:
+			if (ie.left)
+				leftAct = true;
+			else
+				rightAct = true;
+			compute_intersections(ie.origin, ie.direction, ci, ci == 0 ? rgb(1, 0, 0) : rgb(0, 0, 1));
+			if (intersection_points.size()) {
+				isGrab = true;
+				std::cout << "Box chosen with " << (ie.left ? "left" : "right") << " mouse" << std::endl;
+				post_scene_update();
+			}
+			label_outofdate = true; //Shows the chosen box on the info board
+			break;
+		case IE_MOUSE_RELEASE:
+			if (isGrab) {
+				if (drop_to_surface)
+					drop_grabbed_boxes(ci);
+				preview_boxes.clear();
+				preview_colors.clear();
+				preview_translations.clear();
+				preview_rotations.clear();
+				isGrab = false;
+				leftAct = false;
+				rightAct = false;
+				offset = 0.0f;
+				remove_intersections(ci);
+				std::cout << "Released" << std::endl;
+				post_scene_update();
+			}
+			break;
+		case IE_MOUSE_MOVE:
+			update_hover(ie.origin, ie.direction);
+			break;
+		case IE_MOUSE_DRAG:
+			if (!isGrab)
+				break;
+			if (leftAct) {
+				ray mouse_ray;
+				mouse_ray.origin = ie.origin;
+				mouse_ray.direction = ie.direction;
+
+				plane mouse_plane;
+				mouse_plane.origin = ie.focus;
+				mouse_plane.normal = normalize(ie.focus - ie.origin);
+				float t = 0.0f;
+				if (intersect(mouse_ray, mouse_plane, t)) {
+					hit_pos = mouse_ray.origin + t * mouse_ray.direction;
+					move_box(ci, hit_pos, offset, ie.origin);
+				}
+			}
+			else if (rightAct) {
+				// Gives the change of mouse position based on x and y axis, if the mouse movement is slow and gentle always changes by +1 or -1, it can goes high up as <+-92 depending on how sharp the change is
+				quat rot_x = quat(vec3(1.0f, 0.0f, 0.0f), cgv::math::deg2rad(ie.dx * 2));
+				quat rot_y = quat(vec3(0.0f, 1.0f, 0.0f), cgv::math::deg2rad(ie.dy * 2));
+				quat rot_combined = rot_x * rot_y;
+				for (size_t i = 0; i < intersection_points.size(); ++i) {
+					if (intersection_controller_indices[i] != ci)
+						continue;
+					// extract box index
+					unsigned bi = intersection_box_indices[i];
+					movable_box_rotations[bi] *= rot_combined;
+					mark_box_changed(bi);
+				}
+				if (drop_preview)
+					update_drop_preview(ci);
+				post_scene_update();
+			}
+			break;
+		case IE_MOUSE_WHEEL:
+			if (!isGrab)
+				break;
+			offset += 0.1f * ie.dy;
+			move_box(ci, hit_pos, offset, ie.origin);
+			break;
+		case IE_STICK_TOUCH:
+			if (state[ci] == IS_OVER) {
+				state[ci] = IS_GRAB;
+				post_scene_update();
+			}
+			break;
+		case IE_STICK_RELEASE:
+			if (state[ci] == IS_GRAB) {
+				state[ci] = IS_OVER;
+				// released boxes land on the surface below them like with the mouse
+				if (drop_to_surface)
+					drop_grabbed_boxes(ci);
+				preview_boxes.clear();
+				preview_colors.clear();
+				preview_translations.clear();
+				preview_rotations.clear();
+				post_scene_update();
+			}
+			break;
+		case IE_POSE:
+			// record pose for extrapolation to display time
+			pose_histories[ci].add(ie.time, ie.position, ie.orientation);
+			if (state[ci] == IS_GRAB) {
+				// in grab mode apply relative transformation to grabbed boxes
+				// iterate intersection points of current controller
+				for (size_t i = 0; i < intersection_points.size(); ++i) {
+					if (intersection_controller_indices[i] != ci)
+						continue;
+					// extract box index
+					unsigned bi = intersection_box_indices[i];
+					// update translation with position change and rotation
+					movable_box_translations[bi] =
+						ie.rotation * (movable_box_translations[bi] - ie.last_position) + ie.position;
+					// update orientation with rotation, note that quaternions
+					// need to be multiplied in oposite order. In case of matrices
+					// one would write box_orientation_matrix *= rotation
+					movable_box_rotations[bi] = quat(ie.rotation) * movable_box_rotations[bi];
+					mark_box_changed(bi);
+					// update intersection points
+					intersection_points[i] = ie.rotation * (intersection_points[i] - ie.last_position) + ie.position;
+				}
+				if (drop_preview)
+					update_drop_preview(ci);
+			}
+			else {// not grab
+				// clear intersections of current controller
+				remove_intersections(ci);
+				size_t nr_other = intersection_points.size();
+
+				// boxes touched by the controller take precedence over boxes hit by its ray
+				rgb color = ci == 0 ? rgb(1, 0, 0) : rgb(0, 0, 1);
+				if (!touch_grab || !compute_touch_intersections(ie.position, ci, color))
+					compute_intersections(ie.origin, ie.direction, ci, color);
+				if (touch_grab)
+					readouts_outofdate = true;
+				label_outofdate = true;
+
+				// update state based on whether we have found at least 
+				// one intersection with controller ray
+				if (intersection_points.size() == nr_other)
+					state[ci] = IS_NONE;
+				else
+					if (state[ci] == IS_NONE)
+						state[ci] = IS_OVER;
+			}
+			post_scene_update();
+			break;
+		}
+	}
+
+	// whether grabbed boxes are extrapolated to the expected display time of the frame
+	bool pose_prediction;
+	// assumed time from drawing a frame until it is visible, which sets the prediction target
+	float display_latency_ms;
+	// upper bound of the extrapolation interval
+	float max_prediction_ms;
+	// number of samples over which controller velocities are estimated
+	unsigned prediction_window;
+	// average age of the latest controller pose when a frame is drawn
+	float pose_age_ms;
+	// measured time from the latest used controller pose to the end of the frame and from the time the grabbed boxes were predicted for
+	// to the end of the frame, which is negative if they were predicted beyond it
+	float pose_to_frame_end_ms, prediction_to_frame_end_ms;
+	// average time of the latest controller poses and of the predicted poses used in the current frame, negative if no box is grabbed
+	double frame_pose_time, frame_prediction_time;
+	// time of last update of latency readouts
+	double last_readout_time;
+	// controller pose histories written by the interaction thread
+	pose_history pose_histories[4];
+	// box transforms and intersection points of the current frame after prediction
+	std::vector<vec3> predicted_translations;
+	std::vector<quat> predicted_rotations;
+	std::vector<vec3> predicted_points;
+
+	// return seconds on a monotonic clock
+	static double get_time()
+	{
+		return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+	// extrapolate boxes grabbed in the latched scene state to the display time of the current frame
+	void predict_grabbed_boxes()
+	{
+		const scene_state& S = scene_buffer.ref_front();
+		predicted_translations = S.movable_box_translations;
+		predicted_rotations = S.movable_box_rotations;
+		predicted_points = S.intersection_points;
+		double now = get_time();
+		double display_time = now + 0.001 * display_latency_ms;
+		double age_sum = 0, pose_time_sum = 0, prediction_time_sum = 0;
+		unsigned nr_grabbing = 0;
+		frame_pose_time = frame_prediction_time = -1;
+		for (int ci = 0; ci < 4; ++ci) {
+			const pose_history& H = S.controller_histories[ci];
+			if (S.controller_states[ci] != IS_GRAB || H.empty())
+				continue;
+			const pose_history::sample& latest = H.latest();
+			age_sum += now - latest.time;
+			pose_time_sum += latest.time;
+			++nr_grabbing;
+			if (!pose_prediction) {
+				prediction_time_sum += latest.time;
+				continue;
+			}
+			vec3 position;
+			quat orientation;
+			prediction_time_sum += H.predict(display_time, prediction_window, 0.001 * max_prediction_ms, position, orientation);
+			// apply relative transformation from latest to predicted controller pose
+			quat rotation = orientation * latest.orientation.conj();
+			for (size_t i = 0; i < S.intersection_points.size(); ++i) {
+				if (S.intersection_controller_indices[i] != ci)
+					continue;
+				unsigned bi = S.intersection_box_indices[i];
+				predicted_translations[bi] = rotation.apply(S.movable_box_translations[bi] - latest.position) + position;
+				predicted_rotations[bi] = rotation * S.movable_box_rotations[bi];
+				predicted_points[i] = rotation.apply(S.intersection_points[i] - latest.position) + position;
+			}
+		}
+		if (nr_grabbing == 0)
+			return;
+		pose_age_ms = 0.9f * pose_age_ms + 0.1f * float(1000 * age_sum / nr_grabbing);
+		frame_pose_time = pose_time_sum / nr_grabbing;
+		frame_prediction_time = prediction_time_sum / nr_grabbing;
+	}
+	/// measure latencies of the grabbed boxes against the end of the frame drawn with them
+	void measure_frame_latency()
+	{
+		if (frame_pose_time < 0)
+			return;
+		double now = get_time();
+		pose_to_frame_end_ms = 0.9f * pose_to_frame_end_ms + 0.1f * float(1000 * (now - frame_pose_time));
+		prediction_to_frame_end_ms = 0.9f * prediction_to_frame_end_ms + 0.1f * float(1000 * (now - frame_prediction_time));
+		if (now - last_readout_time > 0.25) {
+			last_readout_time = now;
+			update_member(&pose_age_ms);
+			update_member(&pose_to_frame_end_ms);
+			update_member(&prediction_to_frame_end_ms);
+		}
+	}
+
+	// cast a ray straight down from p against static and movable boxes, where movable box skip_bi is ignored
+	bool cast_down(const vec3& p, int skip_bi, vec3& support_point, vec3& support_normal)
+	{
+		bool found = false;
+		float y_hit;
+		if (static_grid.cast_down(boxes, p, y_hit) != -1) {
+			support_point = vec3(p[0], y_hit, p[2]);
+			support_normal = vec3(0, 1, 0);
+			found = true;
+		}
+		if (compact_static_boxes && compact_grid.cast_down(compact_boxes, p, y_hit) != -1 && (!found || y_hit > support_point[1])) {
+			support_point = vec3(p[0], y_hit, p[2]);
+			support_normal = vec3(0, 1, 0);
+			found = true;
+		}
+		// streamed tiles are regular grids of cells, so the cell below p is looked up directly
+		if (const environment_tile* t = environment_streamer.find_tile(p[0], p[2])) {
+			float tile_size = tile_resolution * environment_cell_size;
+			int a = (int)std::floor((p[0] - t->i * tile_size) / environment_cell_size);
+			int b = (int)std::floor((p[2] - t->j * tile_size) / environment_cell_size);
+			if (a >= 0 && b >= 0 && a < (int)tile_resolution && b < (int)tile_resolution) {
+				int bi = t->cell_boxes[b * tile_resolution + a];
+				if (bi != -1) {
+					float y_top = t->boxes[bi].get_max_pnt()[1];
+					if (y_top <= p[1] && (!found || y_top > support_point[1])) {
+						support_point = vec3(p[0], y_top, p[2]);
+						support_normal = vec3(0, 1, 0);
+						found = true;
+					}
+				}
+			}
+		}
+		// movable boxes are found by walking the cells of the spatial hash below p, which stops at the first hit
+		float t_max = found ? p[1] - support_point[1] : std::numeric_limits<float>::infinity();
+		movable_hash.query_ray(p, vec3(0, -1, 0), t_max, [&](unsigned i) {
+			if ((int)i == skip_bi)
+				return;
+			vec3 origin_box_i = p - movable_box_translations[i];
+			movable_box_rotations[i].inverse_rotate(origin_box_i);
+			// ignore boxes that already contain the ray origin
+			if (movable_boxes[i].inside(origin_box_i))
+				return;
+			vec3 direction_box_i(0, -1, 0);
+			movable_box_rotations[i].inverse_rotate(direction_box_i);
+			float t_result;
+			vec3  p_result;
+			vec3  n_result;
+			if (!cgv::media::ray_axis_aligned_box_intersection(
+				origin_box_i, direction_box_i,
+				movable_boxes[i],
+				t_result, p_result, n_result, 0.000001f))
+				return;
+			movable_box_rotations[i].rotate(p_result);
+			p_result += movable_box_translations[i];
+			if (found && p_result[1] <= support_point[1])
+				return;
+			movable_box_rotations[i].rotate(n_result);
+			support_point = p_result;
+			support_normal = n_result;
+			t_max = p[1] - p_result[1];
+			found = true;
+		});
+		return found;
+	}
+	// compute the pose of movable box bi after dropping it onto the highest surface below its footprint
+	bool compute_drop(unsigned bi, vec3& translation, quat& rotation)
+	{
+		const box3& B = movable_boxes[bi];
+		translation = movable_box_translations[bi];
+		rotation = movable_box_rotations[bi];
+		// world space bounding box of the oriented box
+		box3 world_box;
+		for (int c = 0; c < 8; ++c)
+			world_box.add_point(rotation.apply(B.get_corner(c)) + translation);
+		// sample the footprint at its center and slightly inset corners
+		vec3 c = world_box.get_center();
+		vec3 e = 0.4f * world_box.get_extent();
+		float y = world_box.get_min_pnt()[1];
+		vec3 samples[5] = {
+			vec3(c[0], y, c[2]),
+			vec3(c[0] - e[0], y, c[2] - e[2]), vec3(c[0] + e[0], y, c[2] - e[2]),
+			vec3(c[0] - e[0], y, c[2] + e[2]), vec3(c[0] + e[0], y, c[2] + e[2])
+		};
+		bool found = false;
+		vec3 support_point, support_normal;
+		for (const vec3& s : samples) {
+			vec3 sp, sn;
+			if (cast_down(s, (int)bi, sp, sn) && (!found || sp[1] > support_point[1])) {
+				support_point = sp;
+				support_normal = sn;
+				found = true;
+			}
+		}
+		if (!found)
+			return false;
+		// snap rotation such that the box axis closest to the support normal becomes parallel to it
+		int k = 0;
+		float best = 0;
+		for (int a = 0; a < 3; ++a) {
+			vec3 axis(0.0f);
+			axis[a] = 1;
+			float d = dot(rotation.apply(axis), support_normal);
+			if (fabs(d) > fabs(best)) {
+				best = d;
+				k = a;
+			}
+		}
+		vec3 axis(0.0f);
+		axis[k] = best > 0 ? 1.0f : -1.0f;
+		axis = rotation.apply(axis);
+		vec3 rot_axis = cross(axis, support_normal);
+		float s = rot_axis.length();
+		if (s > 0.000001f)
+			rotation = quat(rot_axis / s, atan2(s, dot(axis, support_normal))) * rotation;
+		// move box along the normal until its face rests on the support plane
+		float half_extent = 0.5f * fabs(B.get_extent()[k]);
+		vec3 center = translation + rotation.apply(B.get_center());
+		translation += (half_extent - dot(center - support_point, support_normal)) * support_normal;
+		return true;
+	}
+	// collect indices of boxes grabbed by controller ci ordered from bottom to top
+	void get_grabbed_boxes(int ci, std::vector<unsigned>& box_indices) const
+	{
+		for (size_t i = 0; i < intersection_points.size(); ++i)
+			if (intersection_controller_indices[i] == ci &&
+				std::find(box_indices.begin(), box_indices.end(), (unsigned)intersection_box_indices[i]) == box_indices.end())
+				box_indices.push_back(intersection_box_indices[i]);
+		std::sort(box_indices.begin(), box_indices.end(), [this](unsigned i, unsigned j) {
+			return movable_box_translations[i][1] < movable_box_translations[j][1];
+		});
+	}
+	// drop all boxes grabbed by controller ci onto the surfaces below them
+	void drop_grabbed_boxes(int ci)
+	{
+		auto start = std::chrono::high_resolution_clock::now();
+		grabbed_box_indices.clear();
+		get_grabbed_boxes(ci, grabbed_box_indices);
+		for (unsigned bi : grabbed_box_indices) {
+			vec3 translation;
+			quat rotation;
+			if (compute_drop(bi, translation, rotation)) {
+				movable_box_translations[bi] = translation;
+				movable_box_rotations[bi] = rotation;
+				mark_box_changed(bi);
+			}
+		}
+		drop_time_us = std::chrono::duration<float, std::micro>(std::chrono::high_resolution_clock::now() - start).count();
+		readouts_outofdate = true;
+	}
+	// compute landing poses of the boxes grabbed by controller ci without moving them
+	void update_drop_preview(int ci)
+	{
+		preview_boxes.clear();
+		preview_colors.clear();
+		preview_translations.clear();
+		preview_rotations.clear();
+		grabbed_box_indices.clear();
+		get_grabbed_boxes(ci, grabbed_box_indices);
+		for (unsigned bi : grabbed_box_indices) {
+			vec3 translation;
+			quat rotation;
+			if (compute_drop(bi, translation, rotation)) {
+				preview_boxes.push_back(movable_boxes[bi]);
+				const rgb& c = movable_box_colors[bi];
+				preview_colors.push_back(rgb(0.5f * c[0], 0.5f * c[1], 0.5f * c[2]));
+				preview_translations.push_back(translation);
+				preview_rotations.push_back(rotation);
+			}
+		}
+	}
+
+	// remove intersections of controller ci in a single pass that keeps the order and capacity of the arrays
+	void remove_intersections(int ci)
+	{
+		size_t j = 0;
+		for (size_t i = 0; i < intersection_points.size(); ++i) {
+			if (intersection_controller_indices[i] == ci)
+				continue;
+			if (j != i) {
+				intersection_points[j] = intersection_points[i];
+				intersection_colors[j] = intersection_colors[i];
+				intersection_box_indices[j] = intersection_box_indices[i];
+				intersection_controller_indices[j] = intersection_controller_indices[i];
+			}
+			++j;
+		}
+		intersection_points.resize(j);
+		intersection_colors.resize(j);
+		intersection_box_indices.resize(j);
+		intersection_controller_indices.resize(j);
+	}
+	// compute intersection point of the box that is closest to the picking cone around the controller ray
+	void compute_cone_intersection(const vec3& origin, const vec3& direction, int ci, const rgb& color)
+	{
+		auto start = std::chrono::high_resolution_clock::now();
+		float half_angle = cone_angle * 3.14159265f / 180.0f;
+		picker.set_cone(origin, direction, half_angle);
+		int best_bi = -1;
+		float best_score = 0;
+		vec3 best_point;
+		cone_candidates = 0;
+		auto test = [&](unsigned i) {
+			++cone_candidates;
+			float score;
+			vec3 point;
+			if (picker.test_box(movable_boxes[i], movable_box_translations[i], movable_box_rotations[i], cone_depth_weight, score, point) &&
+				(best_bi == -1 || score < best_score)) {
+				best_bi = (int)i;
+				best_score = score;
+				best_point = point;
+				return true;
+			}
+			return false;
+		};
+		// walking the hash costs more than testing a few boxes directly, with 20 boxes about 20 us against 3 us
+		if (movable_boxes.size() <= 64) {
+			for (unsigned i = 0; i < movable_boxes.size(); ++i)
+				test(i);
+		}
+		else {
+			// boxes reaching into the cone only behind axis parameter t score at least depth weight times t, so the best score bounds the walk
+			float t_max = std::numeric_limits<float>::infinity();
+			movable_hash.query_cone(origin, normalize(direction), half_angle, t_max, [&](unsigned i) {
+				if (test(i) && cone_depth_weight > 0)
+					t_max = best_score / cone_depth_weight;
+			});
+		}
+		cone_time_us = std::chrono::duration<float, std::micro>(std::chrono::high_resolution_clock::now() - start).count();
+		readouts_outofdate = true;
+		if (best_bi == -1)
+			return;
+		intersection_points.push_back(best_point);
+		intersection_colors.push_back(color);
+		intersection_box_indices.push_back(best_bi);
+		intersection_controller_indices.push_back(ci);
+	}
+	// compute intersection points of controller ray with movable boxes
+	void compute_intersections(const vec3& origin, const vec3& direction, int ci, const rgb& color)
+	{
+		if (cone_picking) {
+			compute_cone_intersection(origin, direction, ci, color);
+			return;
+		}
+		for (size_t i = 0; i < movable_boxes.size(); ++i) {
+			vec3 origin_box_i = origin - movable_box_translations[i];
+			movable_box_rotations[i].inverse_rotate(origin_box_i);
+			vec3 direction_box_i = direction;
+			movable_box_rotations[i].inverse_rotate(direction_box_i);
+			float t_result;
+			vec3  p_result;
+			vec3  n_result;
+			if (cgv::media::ray_axis_aligned_box_intersection(
+				origin_box_i, direction_box_i,
+				movable_boxes[i],
+				t_result, p_result, n_result, 0.000001f)) {
+
+				// transform result back to world coordinates
+				movable_box_rotations[i].rotate(p_result);
+				p_result += movable_box_translations[i];
+				movable_box_rotations[i].rotate(n_result);
+
+				// store intersection information
+				intersection_points.push_back(p_result);
+				intersection_colors.push_back(color);
+				intersection_box_indices.push_back((int)i);
+				intersection_controller_indices.push_back(ci);
+			}
+		}
+	}
+	/// register on device change events
+	void on_device_change(void* kit_handle, bool attach)
+	{
+		if (attach) {
+			if (last_kit_handle == 0) {
+				vr::vr_kit* kit_ptr = vr::get_vr_kit(kit_handle);
+				if (kit_ptr) {
+					last_kit_handle = kit_handle;
+					left_deadzone_and_precision = kit_ptr->get_controller_throttles_and_sticks_deadzone_and_precision(0);
+					cgv::gui::ref_vr_server().provide_controller_throttles_and_sticks_deadzone_and_precision(kit_handle, 0, &left_deadzone_and_precision);
+					post_recreate_gui();
+				}
+			}
+		}
+		else {
+			if (kit_handle == last_kit_handle) {
+				last_kit_handle = 0;
+				post_recreate_gui();
+			}
+		}
+	}
+	/// switch environment boxes between float and compact storage, the few room boxes always stay in float
+	void set_compact_static_boxes(bool compact)
+	{
+		if (compact) {
+			compact_boxes.build(boxes.data() + nr_room_boxes, box_colors.data() + nr_room_boxes, boxes.size() - nr_room_boxes, 16.0f);
+			boxes.resize(nr_room_boxes);
+			boxes.shrink_to_fit();
+			box_colors.resize(nr_room_boxes);
+			box_colors.shrink_to_fit();
+			compact_grid.build(compact_boxes, 0.25f);
+			// the far field is not applied to compact storage
+			build_environment_lod();
+		}
+		else {
+			compact_boxes.decode_boxes(boxes);
+			for (const rgb8& c : compact_boxes.get_colors())
+				box_colors.push_back(rgb(c[0] / 255.0f, c[1] / 255.0f, c[2] / 255.0f));
+			compact_boxes.clear();
+			compact_grid.build(compact_boxes, 0.25f);
+			std::vector<box3>().swap(decoded_boxes);
+			build_environment_lod();
+		}
+		static_grid.build(boxes, 0.25f);
+		static_boxes_outofdate = true;
+		compact_boxes_outofdate = true;
+	}
+	/// compute memory footprint of static and movable boxes for float and compact layout
+	void report_footprint()
+	{
+		std::lock_guard<std::mutex> lock(interaction_mutex);
+		compact_box_array measured;
+		const compact_box_array* compact_ptr = &compact_boxes;
+		if (!compact_static_boxes) {
+			measured.build(boxes.data() + nr_room_boxes, box_colors.data() + nr_room_boxes, boxes.size() - nr_room_boxes, 16.0f);
+			compact_ptr = &measured;
+		}
+		size_t n = compact_ptr->size();
+		size_t m = movable_boxes.size();
+		size_t float_static = (n + nr_room_boxes) * (sizeof(box3) + sizeof(rgb));
+		size_t compact_static = nr_room_boxes * (sizeof(box3) + sizeof(rgb)) + compact_ptr->get_nr_bytes();
+		// movable boxes are drawn from their geometry, colors and one transform per frame
+		size_t float_movable = m * (sizeof(box3) + sizeof(rgb) + sizeof(vec3) + sizeof(quat));
+		size_t compact_movable = m * (sizeof(compact_box_array::box) + sizeof(rgb8) + sizeof(compact_transform));
+		footprint_float_mb = float(float_static + float_movable) / (1024 * 1024);
+		footprint_compact_mb = float(compact_static + compact_movable) / (1024 * 1024);
+		std::cout << "static boxes:  " << nr_room_boxes << " room and " << n << " environment in " << compact_ptr->get_nr_chunks() << " chunks, "
+			<< float_static << " bytes float, " << compact_static << " bytes compact" << std::endl;
+		std::cout << "movable boxes: " << m << ", "
+			<< float_movable << " bytes float, " << compact_movable << " bytes compact" << std::endl;
+		// compact boxes are uploaded as they are stored, so the gpu footprint equals the compact footprint unless decoding is needed
+		if (compact_renderer.is_initialized())
+			std::cout << "gpu bytes of compact boxes: " << compact_renderer.get_nr_gpu_bytes() << " static, "
+				<< movable_compact_renderer.get_nr_gpu_bytes() << " movable" << std::endl;
+		else
+			std::cout << "compact box program not available, compact boxes are uploaded decoded to float" << std::endl;
+		update_member(&footprint_float_mb);
+		update_member(&footprint_compact_mb);
+	}
+	/// measure throughput of the ray box intersection kernel for all ray distributions
+	void benchmark_intersections()
+	{
+		for (int rd = cgv::media::RD_RANDOM; rd <= cgv::media::RD_ADVERSARIAL; ++rd) {
+			cgv::media::ray_box_set<float> S;
+			cgv::media::generate_ray_box_set((cgv::media::RayDistribution)rd, 100000, 1, S);
+			cgv::media::ray_box_benchmark_result r = cgv::media::benchmark_ray_box_intersection(S, 20, 0.000001f);
+			std::cout << cgv::media::get_ray_distribution_name((cgv::media::RayDistribution)rd) << ": "
+				<< r.rays_per_second * 0.000001 << " Mrays/s, " << r.nr_hits << " hits of " << r.nr_rays << " rays" << std::endl;
+		}
+	}
+	/// compare the ray box intersection kernel against a high precision reference for all ray distributions
+	void check_intersections()
+	{
+		for (int rd = cgv::media::RD_RANDOM; rd <= cgv::media::RD_ADVERSARIAL; ++rd) {
+			cgv::media::ray_box_set<float> S;
+			cgv::media::generate_ray_box_set((cgv::media::RayDistribution)rd, 100000, 2, S);
+			cgv::media::ray_box_check_result r = cgv::media::check_ray_box_intersection(S, 0.000001f, 0.0001f);
+			std::cout << cgv::media::get_ray_distribution_name((cgv::media::RayDistribution)rd) << ": "
+				<< r.nr_tests << " tests, " << r.nr_boundary << " near a boundary, "
+				<< r.nr_hit_mismatches << " hit, " << r.nr_t_mismatches << " t and "
+				<< r.nr_normal_mismatches << " normal mismatches, max t error " << r.max_t_error << std::endl;
+		}
+	}
+	/// construct boxes that represent a table of dimensions tw,td,th and leg width tW
+	void construct_table(float tw, float td, float th, float tW);
+	/// construct boxes that represent a room of dimensions w,d,h and wall width W
+	void construct_room(float w, float d, float h, float W, bool walls, bool ceiling);
+	/// construct boxes for environment
+	void construct_environment(float s, float ew, float ed, float eh, float w, float d, float h);
+	/// construct boxes of the environment tile t with n x n cells of size s outside the room of dimensions w,d
+	static void construct_environment_tile(environment_tile& t, float s, unsigned n, float w, float d, float max_height);
+	/// read environment tile t with n x n cells from directory dir and return whether this succeeded
+	static bool read_environment_tile(const std::string& dir, unsigned n, environment_tile& t);
+	/// construct boxes that represent a table of dimensions tw,td,th and leg width tW
+	void construct_movable_boxes(float tw, float td, float th, float tW, size_t nr);
+	// construction of the scene started in the constructor, invalid once it has been waited for
+	std::future<void> scene_building;
+	/// wait for the construction of the scene if it has not finished before
+	void wait_for_scene()
+	{
+		if (!scene_building.valid())
+			return;
+		startup_tracer::scope trace(ref_startup_tracer(), "wait for scene");
+		scene_building.get();
+	}
+	/// construct a scene with a table
+	void build_scene(float w, float d, float h, float W,
+		float tw, float td, float th, float tW)
+	{
+		room_w = w;
+		room_d = d;
+		room_h = h;
+		construct_room(w, d, h, W, false, false);
+		construct_table(tw, td, th, tW);
+		nr_room_boxes = boxes.size();
+		construct_environment(environment_cell_size, 3 * w, 3 * d, h, w, d, h);
+		build_environment_lod();
+		construct_movable_boxes(tw, td, th, tW, 20);
+		build_movable_hash();
+		static_grid.build(boxes, 0.25f);
+		static_boxes_outofdate = true;
+		movable_boxes_outofdate = true;
+		compact_boxes_outofdate = false;
+	}
+public:
+	natural_interfaces() : ray_positions(draw_arena), ray_colors(draw_arena), label_positions(draw_arena), label_texcoords(draw_arena)
+	{
+		startup_tracer::scope trace(ref_startup_tracer(), "construct plugin");
+		set_name("natural_interfaces");
+		environment_cell_size = 0.2f;
+		far_field_lod = false;
+		lod_distance = 8.0f;
+		lod_block_resolution = 8;
+		std::fill(lod_viewer_block, lod_viewer_block + 3, 0);
+		lod_ranges_outofdate = true;
+		nr_drawn_boxes = 0;
+		arena_peak = 0;
+		frame_allocations = 0;
+		last_nr_allocations = 0;
+		frame_index = 0;
+		prepared_frame = (unsigned)-1;
+		nr_static_boxes = 0;
+		views_per_frame = nr_views = 0;
+		vr_view_ptr = 0;
+		ray_length = 2;
+		cone_picking = false;
+		replicate = false;
+		host_relay = true;
+		relay_port = 47800;
+		replication_out_kbps = replication_in_kbps = replication_rtt_ms = replication_latency_ms = 0;
+		last_replication_report = 0;
+		test_clients = 4;
+		test_churn = 10;
+		test_seconds = 2.0f;
+		share_transforms = false;
+		shared_memory_name = "natural_interfaces_transforms";
+		published_changes = 0;
+		publisher_grow_failed = false;
+		touch_grab = true;
+		touch_radius = 0.03f;
+		touch_time_us = 0;
+		touch_candidates = 0;
+		hover_highlight = true;
+		hovered_box = highlighted_box = -1;
+		hover_bounded_queries = hover_unbounded_queries = hover_tests = 0;
+		cone_angle = 2.0f;
+		cone_depth_weight = 0.1f;
+		cone_time_us = 0;
+		cone_candidates = 0;
+		last_kit_handle = 0;
+		connect(cgv::gui::ref_vr_server().on_device_change, this, &natural_interfaces::on_device_change);
+		connect(cgv::gui::get_animation_trigger().shoot, this, &natural_interfaces::timer_event);
+
+		mesh_scale = 0.001f;
+		mesh_location = dvec3(0, 1.1f, 0);
+		mesh_orientation = dquat(1, 0, 0, 0);
+
+		srs.radius = 0.005f;
+
+		label_outofdate = true;
+		label_text = "Info Board";
+		label_font_idx = 0;
+		label_upright = true;
+		label_face_type = cgv::media::font::FFA_BOLD;
+		label_resolution = 256;
+		label_size = 20.0f;
+		label_color = rgb(1, 1, 1);
+
+		//Mouse Events
+		mouse_ray_activated = false;
+		isGrab = false;
+		offset = 0.0f;
+		hit_pos(0.0f);
+
+		drop_to_surface = false;
+		drop_preview = false;
+		drop_time_us = 0.0f;
+
+		compact_static_boxes = false;
+		compact_movable_boxes = false;
+		footprint_float_mb = footprint_compact_mb = 0.0f;
+
+		stream_environment = false;
+		world_size = 2000.0f;
+		tile_resolution = 64;
+		load_radius = 60.0f;
+		evict_radius = 80.0f;
+		upload_budget = 2;
+		tiles_outofdate = false;
+		environment_max_height = 20.0f;
+		tiles_resident = tiles_in_flight = tiles_evicted = 0;
+
+		// fonts are enumerated and looked up lazily in ensure_fonts and ensure_label_font
+		label_font_name = "calibri";
+		time_to_first_frame_ms = 0;
+		state[0] = state[1] = state[2] = state[3] = IS_NONE;
+
+		pose_prediction = true;
+		display_latency_ms = 20.0f;
+		max_prediction_ms = 50.0f;
+		prediction_window = 3;
+		pose_age_ms = pose_to_frame_end_ms = prediction_to_frame_end_ms = 0.0f;
+		frame_pose_time = frame_prediction_time = -1;
+		last_readout_time = 0;
+		scene_update_pending = false;
+		redraw_requested = readouts_outofdate = false;
+		last_interaction_readout_time = 0;
+		// the scene is built while the framework creates the window and is waited for when it is first needed
+		scene_building = std::async(std::launch::async, [this]() {
+			startup_tracer::scope trace_scene(ref_startup_tracer(), "build scene");
+			build_scene(5, 7, 3, 0.2f, 1.6f, 0.8f, 0.9f, 0.03f);
+			publish_scene_state();
+		});
+	}
+	/// stop the interaction thread before the state it works on is destructed
+	~natural_interfaces()
+	{
+		stop_interaction();
+	}
+	std::string get_type_name() const
+	{
+		return "natural_interfaces";
+	}
+	void create_gui()
+	{
+		wait_for_scene();
+		add_decorator("natural_interfaces", "heading", "level=2");
+		add_member_control(this, "mesh_scale", mesh_scale, "value_slider", "min=0.1;max=10;log=true;ticks=true");
+		add_gui("mesh_location", mesh_location, "vector", "options='min=-3;max=3;ticks=true");
+		add_gui("mesh_orientation", static_cast<dvec4&>(mesh_orientation), "direction", "options='min=-1;max=1;ticks=true");
+		add_member_control(this, "ray_length", ray_length, "value_slider", "min=0.1;max=10;log=true;ticks=true");
+		if (last_kit_handle) {
+			vr::vr_kit* kit_ptr = vr::get_vr_kit(last_kit_handle);
+			const std::vector<std::pair<int, int> >* t_and_s_ptr = 0;
+			if (kit_ptr)
+				t_and_s_ptr = &kit_ptr->get_controller_throttles_and_sticks(0);
+			add_decorator("deadzone and precisions", "heading", "level=3");
+			int ti = 0;
+			int si = 0;
+			for (unsigned i = 0; i < left_deadzone_and_precision.size(); ++i) {
+				std::string prefix = std::string("unknown[") + cgv::utils::to_string(i) + "]";
+				if (t_and_s_ptr) {
+					if (t_and_s_ptr->at(i).second == -1)
+						prefix = std::string("throttle[") + cgv::utils::to_string(ti++) + "]";
+					else
+						prefix = std::string("stick[") + cgv::utils::to_string(si++) + "]";
+				}
+				add_member_control(this, prefix + ".deadzone", left_deadzone_and_precision[i].first, "value_slider", "min=0;max=1;ticks=true;log=true");
+				add_member_control(this, prefix + ".precision", left_deadzone_and_precision[i].second, "value_slider", "min=0;max=1;ticks=true;log=true");
+			}
+		}
+		if (begin_tree_node("box style", style)) {
+			align("\a");
+			add_gui("box style", style);
+			align("\b");
+			end_tree_node(style);
+		}
+		if (begin_tree_node("compact storage", compact_static_boxes)) {
+			align("\a");
+			add_member_control(this, "compact static boxes", compact_static_boxes, "toggle");
+			add_member_control(this, "compact movable boxes", compact_movable_boxes, "toggle");
+			connect_copy(add_button("report footprint")->click, cgv::signal::rebind(this, &natural_interfaces::report_footprint));
+			add_view("float [MB]", footprint_float_mb);
+			add_view("compact [MB]", footprint_compact_mb);
+			align("\b");
+			end_tree_node(compact_static_boxes);
+		}
+		if (begin_tree_node("far field", far_field_lod)) {
+			align("\a");
+			// compact storage keeps no float copy of the environment to build blocks from, so only streamed tiles get a far field
+			if (compact_static_boxes && !stream_environment)
+				add_decorator("far field not available with compact storage", "heading", "level=4");
+			else
+				add_member_control(this, "far field lod", far_field_lod, "toggle");
+			add_member_control(this, "lod distance", lod_distance, "value_slider", "min=1;max=500;log=true;ticks=true");
+			add_member_control(this, "block resolution", lod_block_resolution, "value_slider", "min=2;max=32;ticks=true");
+			add_view("boxes drawn", nr_drawn_boxes);
+			add_view("views per frame", views_per_frame);
+			align("\b");
+			end_tree_node(far_field_lod);
+		}
+		if (begin_tree_node("environment streaming", stream_environment)) {
+			align("\a");
+			add_member_control(this, "stream environment", stream_environment, "toggle");
+			add_member_control(this, "world size", world_size, "value_slider", "min=50;max=10000;log=true;ticks=true");
+			add_member_control(this, "max height", environment_max_height, "value_slider", "min=1;max=200;log=true;ticks=true");
+			add_member_control(this, "tile directory", tile_directory);
+			add_member_control(this, "load radius", load_radius, "value_slider", "min=5;max=500;log=true;ticks=true");
+			add_member_control(this, "evict radius", evict_radius, "value_slider", "min=5;max=600;log=true;ticks=true");
+			add_member_control(this, "upload budget", upload_budget, "value_slider", "min=1;max=16;ticks=true");
+			add_view("tiles resident", tiles_resident);
+			add_view("tiles in flight", tiles_in_flight);
+			add_view("tiles evicted", tiles_evicted);
+			align("\b");
+			end_tree_node(stream_environment);
+		}
+		if (begin_tree_node("movable box style", movable_style)) {
+			align("\a");
+			add_gui("movable box style", movable_style);
+			align("\b");
+			end_tree_node(movable_style);
+		}
+		if (begin_tree_node("drop to surface", drop_to_surface)) {
+			align("\a");
+			add_member_control(this, "drop on release", drop_to_surface, "toggle");
+			add_member_control(this, "preview while dragging", drop_preview, "toggle");
+			add_view("query time [us]", drop_time_us);
+			align("\b");
+			end_tree_node(drop_to_surface);
+		}
+		if (begin_tree_node("replication", replicate)) {
+			align("\a");
+			add_member_control(this, "host relay", host_relay, "toggle");
+			add_member_control(this, "relay port", relay_port, "value_slider", "min=1024;max=65535");
+			add_member_control(this, "replicate", replicate, "toggle");
+			add_view("out [kB/s]", replication_out_kbps);
+			add_view("in [kB/s]", replication_in_kbps);
+			add_view("round trip [ms]", replication_rtt_ms);
+			add_view("latency [ms]", replication_latency_ms);
+			add_member_control(this, "test clients", test_clients, "value_slider", "min=1;max=32;ticks=true");
+			add_member_control(this, "test churn", test_churn, "value_slider", "min=0;max=1000;log=true;ticks=true");
+			add_member_control(this, "test seconds", test_seconds, "value_slider", "min=0.5;max=20;ticks=true");
+			connect_copy(add_button("run test")->click, cgv::signal::rebind(this, &natural_interfaces::test_replication));
+			align("\b");
+			end_tree_node(replicate);
+		}
+		if (begin_tree_node("shared transforms", share_transforms)) {
+			align("\a");
+			add_member_control(this, "name", shared_memory_name);
+			add_member_control(this, "publish", share_transforms, "toggle");
+			add_view("changed transforms", published_changes);
+			align("\b");
+			end_tree_node(share_transforms);
+		}
+		if (begin_tree_node("startup", time_to_first_frame_ms)) {
+			align("\a");
+			add_view("time to first frame [ms]", time_to_first_frame_ms);
+			connect_copy(add_button("report startup")->click, cgv::signal::rebind(this, &natural_interfaces::report_startup));
+			align("\b");
+			end_tree_node(time_to_first_frame_ms);
+		}
+		if (begin_tree_node("allocations", frame_allocations)) {
+			align("\a");
+			if (allocation_counter::is_enabled())
+				add_view("heap allocations per frame", frame_allocations);
+			else
+				add_decorator("build with NI_COUNT_ALLOCATIONS to count heap allocations", "heading", "level=4");
+			add_view("frame arena peak [B]", arena_peak);
+			align("\b");
+			end_tree_node(frame_allocations);
+		}
+		if (begin_tree_node("pose prediction", pose_prediction)) {
+			align("\a");
+			add_member_control(this, "predict grabbed boxes", pose_prediction, "toggle");
+			add_member_control(this, "assumed display latency [ms]", display_latency_ms, "value_slider", "min=0;max=100;ticks=true");
+			add_member_control(this, "max prediction [ms]", max_prediction_ms, "value_slider", "min=0;max=100;ticks=true");
+			add_member_control(this, "velocity window", prediction_window, "value_slider", "min=1;max=7;ticks=true");
+			add_view("pose age [ms]", pose_age_ms);
+			add_view("pose to frame end [ms]", pose_to_frame_end_ms);
+			add_view("prediction to frame end [ms]", prediction_to_frame_end_ms);
+			align("\b");
+			end_tree_node(pose_prediction);
+		}
+		if (begin_tree_node("intersections", srs)) {
+			align("\a");
+			add_member_control(this, "cone picking", cone_picking, "toggle");
+			add_member_control(this, "cone angle", cone_angle, "value_slider", "min=0.1;max=15;log=true;ticks=true");
+			add_member_control(this, "cone depth weight", cone_depth_weight, "value_slider", "min=0;max=1;ticks=true");
+			add_view("cone pick [us]", cone_time_us);
+			add_view("cone candidates", cone_candidates);
+			add_member_control(this, "touch grab", touch_grab, "toggle");
+			add_member_control(this, "touch radius", touch_radius, "value_slider", "min=0.005;max=0.2;log=true;ticks=true");
+			add_view("touch query [us]", touch_time_us);
+			add_view("touch candidates", touch_candidates);
+			add_member_control(this, "highlight hovered box", hover_highlight, "toggle");
+			add_view("bounded hover queries", hover_bounded_queries);
+			add_view("unbounded hover queries", hover_unbounded_queries);
+			add_view("boxes tested", hover_tests);
+			connect_copy(add_button("benchmark kernel")->click, cgv::signal::rebind(this, &natural_interfaces::benchmark_intersections));
+			connect_copy(add_button("check kernel")->click, cgv::signal::rebind(this, &natural_interfaces::check_intersections));
+			add_gui("sphere style", srs);
+			align("\b");
+			end_tree_node(srs);
+		}
+		if (begin_tree_node("mesh", mesh_scale)) {
+			align("\a");
+			add_member_control(this, "scale", mesh_scale, "value_slider", "min=0.0001;step=0.0000001;max=100;log=true;ticks=true");
+			add_gui("location", mesh_location, "", "main_label='';long_label=true;gui_type='value_slider';options='min=-2;max=2;step=0.001;ticks=true'");
+			add_gui("orientation", static_cast<dvec4&>(mesh_orientation), "direction", "main_label='';long_label=true;gui_type='value_slider';options='min=-1;max=1;step=0.001;ticks=true'");
+			align("\b");
+			end_tree_node(mesh_scale);
+		}
+
+		if (begin_tree_node("label", label_size)) {
+			align("\a");
+			add_member_control(this, "text", label_text);
+			add_member_control(this, "upright", label_upright);
+			ensure_fonts();
+			add_member_control(this, "font", (cgv::type::DummyEnum&)label_font_idx, "dropdown", font_enum_decl);
+			add_member_control(this, "face", (cgv::type::DummyEnum&)label_face_type, "dropdown", "enums='regular,bold,italics,bold+italics'");
+			add_member_control(this, "size", label_size, "value_slider", "min=8;max=64;ticks=true");
+			add_member_control(this, "color", label_color);
+			add_member_control(this, "resolution", (cgv::type::DummyEnum&)label_resolution, "dropdown", "enums='256=256,512=512,1024=1024,2048=2048'");
+			align("\b");
+			end_tree_node(label_size);
+		}
+	}
+	void on_set(void* member_ptr)
+	{
+		wait_for_scene();
+		// static boxes, streamed tiles, the publisher and the replication are also used by the interaction thread
+		std::lock_guard<std::mutex> lock(interaction_mutex);
+		if (member_ptr == &compact_static_boxes)
+			set_compact_static_boxes(compact_static_boxes);
+		if (member_ptr == &compact_movable_boxes)
+			movable_boxes_outofdate = true;
+		// availability of the far field toggle depends on storage and streaming
+		if (member_ptr == &compact_static_boxes || member_ptr == &stream_environment)
+			post_recreate_gui();
+		if (member_ptr == &replicate || (replicate && (member_ptr == &host_relay || member_ptr == &relay_port)))
+			set_replicate(replicate);
+		if (member_ptr == &share_transforms || (share_transforms && member_ptr == &shared_memory_name))
+			set_share_transforms(share_transforms);
+		// restart streaming to apply changed generation parameters
+		if (member_ptr == &stream_environment ||
+			(stream_environment && (member_ptr == &world_size || member_ptr == &environment_max_height || member_ptr == &tile_directory)))
+			set_stream_environment(stream_environment);
+		// the far field only selects other draw ranges unless the blocks change
+		if (member_ptr == &far_field_lod || member_ptr == &lod_distance)
+			lod_ranges_outofdate = true;
+		if (member_ptr == &lod_block_resolution) {
+			if (stream_environment)
+				set_stream_environment(true);
+			else if (!compact_static_boxes) {
+				build_environment_lod();
+				// building the blocks reorders the environment boxes
+				static_grid.build(boxes, 0.25f);
+			}
+		}
+		if (member_ptr == &label_face_type || member_ptr == &label_font_idx) {
+			if (member_ptr == &label_font_idx && label_font_idx < (int)font_names.size())
+				label_font_name = font_names[label_font_idx];
+			// look up the new face when the label is rendered next
+			label_font_face.clear();
+			label_outofdate = true;
+		}
+		if ((member_ptr >= &label_color && member_ptr < &label_color + 1) ||
+			member_ptr == &label_size || member_ptr == &label_text) {
+			label_outofdate = true;
+		}
+		update_member(member_ptr);
+		post_redraw();
+	}
+	/// compute the ray through the center of pixel x,y from the view parameters, which unlike unprojecting the depth under the
+	/// cursor needs no read back of the depth buffer on every mouse move
+	static void compute_pixel_ray(const cgv::render::view& view, const cgv::render::context& ctx, int x, int y, vec3& origin, vec3& direction)
+	{
+		vec3 view_dir = normalize(vec3(view.get_view_dir()));
+		vec3 right = normalize(cross(view_dir, vec3(view.get_view_up_dir())));
+		vec3 up = cross(right, view_dir);
+		float w = (float)std::max(1, (int)ctx.get_width()), h = (float)std::max(1, (int)ctx.get_height());
+		float aspect = w / h;
+		// pixel center in normalized device coordinates with y pointing up
+		float u = 2.0f * (x + 0.5f) / w - 1.0f;
+		float v = 1.0f - 2.0f * (y + 0.5f) / h;
+		vec3 offset = u * aspect * right + v * up;
+		double angle = view.get_y_view_angle();
+		if (angle <= 0.0) {
+			// orthographic views shoot parallel rays from the pixel on the plane through the eye
+			origin = vec3(view.get_eye()) + float(0.5 * view.get_y_extent_at_focus()) * offset;
+			direction = view_dir;
+		}
+		else {
+			origin = vec3(view.get_eye());
+			direction = normalize(view_dir + float(std::tan(0.5 * angle * 3.14159265358979 / 180.0)) * offset);
+		}
+	}
+	void stream_help(std::ostream& os)
+	{
+		os << "vr_test: no shortcuts defined" << std::endl;
+	}
+	bool handle(cgv::gui::event& e)
+	{
+		wait_for_scene();
+		auto view_ptr = find_view_as_node();
+		cgv::render::context* ctx = get_context();
+
+		if (e.get_kind() == cgv::gui::EID_KEY) {
+			const cgv::gui::key_event& ke = static_cast<const cgv::gui::key_event&>(e);
+			if (ke.get_action() != cgv::gui::KA_RELEASE)
+				if (ke.get_key() == 'C')
+					if (mouse_ray_activated)
+							mouse_ray_activated = false;
+					else
+						mouse_ray_activated = true;
+
+		}
+		if (mouse_ray_activated) {
+			if (e.get_kind() == cgv::gui::EID_MOUSE)  {
+				const cgv::gui::mouse_event& me = static_cast<const cgv::gui::mouse_event&>(e);
+				// only the ray through the cursor is computed here where view and context are available, the interaction thread picks and moves
+				interaction_event ie;
+				ie.ci = 0;
+				ie.left = me.get_button() == cgv::gui::MB_LEFT_BUTTON;
+				ie.dx = (float)me.get_dx();
+				ie.dy = (float)me.get_dy();
+				bool unproject = true;
+				switch (me.get_action()) {
+				case cgv::gui::MA_PRESS:
+					if (me.get_button() != cgv::gui::MB_LEFT_BUTTON && me.get_button() != cgv::gui::MB_RIGHT_BUTTON)
+						return false;
+					ie.kind = IE_MOUSE_PRESS;
+					break;
+				case cgv::gui::MA_RELEASE:
+					ie.kind = IE_MOUSE_RELEASE;
+					unproject = false;
+					break;
+				case cgv::gui::MA_MOVE:
+					if (!hover_highlight)
+						return false;
+					ie.kind = IE_MOUSE_MOVE;
+					break;
+				case cgv::gui::MA_DRAG:
+					ie.kind = IE_MOUSE_DRAG;
+					break;
+				case cgv::gui::MA_WHEEL:
+					ie.kind = IE_MOUSE_WHEEL;
+					unproject = false;
+					break;
+				default:
+					return false;
+				}
+				ie.origin = view_ptr->get_eye();
+				ie.focus = view_ptr->get_focus();
+				if (unproject)
+					compute_pixel_ray(*view_ptr, *ctx, me.get_x(), me.get_y(), ie.origin, ie.direction);
+				interaction_events.push(ie);
+				post_redraw();
+				return ie.kind == IE_MOUSE_WHEEL && isGrab;
+			}
+		}
+
+		// check if vr event flag is not set and don't process events in this case
+		if ((e.get_flags() & cgv::gui::EF_VR) == 0)
+			return false;
+		// check event id
+		switch (e.get_kind()) {
+		case cgv::gui::EID_KEY:
+		{
+			cgv::gui::vr_key_event& vrke = static_cast<cgv::gui::vr_key_event&>(e);
+			if (vrke.get_action() != cgv::gui::KA_RELEASE) {
+				switch (vrke.get_key()) {
+				case vr::VR_LEFT_BUTTON0:
+					std::cout << "button 0 of left controller pressed" << std::endl;
+					return true;
+				case vr::VR_RIGHT_STICK_RIGHT:
+					std::cout << "touch pad of right controller pressed at right direction" << std::endl;
+					return true;
+				}
+			}
+			break;
+		}
+		case cgv::gui::EID_THROTTLE:
+		{
+			cgv::gui::vr_throttle_event& vrte = static_cast<cgv::gui::vr_throttle_event&>(e);
+			std::cout << "throttle " << vrte.get_throttle_index() << " of controller " << vrte.get_controller_index()
+				<< " adjusted from " << vrte.get_last_value() << " to " << vrte.get_value() << std::endl;
+			return true;
+		}
+		case cgv::gui::EID_STICK:
+		{
+			cgv::gui::vr_stick_event& vrse = static_cast<cgv::gui::vr_stick_event&>(e);
+			switch (vrse.get_action()) {
+			case cgv::gui::SA_TOUCH:
+			case cgv::gui::SA_RELEASE:
+			{
+				interaction_event ie;
+				ie.kind = vrse.get_action() == cgv::gui::SA_TOUCH ? IE_STICK_TOUCH : IE_STICK_RELEASE;
+				ie.ci = vrse.get_controller_index();
+				interaction_events.push(ie);
+				post_redraw();
+				break;
+			}
+			case cgv::gui::SA_PRESS:
+			case cgv::gui::SA_UNPRESS:
+				std::cout << "stick " << vrse.get_stick_index()
+					<< " of controller " << vrse.get_controller_index()
+					<< " " << cgv::gui::get_stick_action_string(vrse.get_action())
+					<< " at " << vrse.get_x() << ", " << vrse.get_y() << std::endl;
+				return true;
+			case cgv::gui::SA_MOVE:
+			case cgv::gui::SA_DRAG:
+				std::cout << "stick " << vrse.get_stick_index()
+					<< " of controller " << vrse.get_controller_index()
+					<< " " << cgv::gui::get_stick_action_string(vrse.get_action())
+					<< " from " << vrse.get_last_x() << ", " << vrse.get_last_y()
+					<< " to " << vrse.get_x() << ", " << vrse.get_y() << std::endl;
+				return true;
+			}
+			return true;
+		}
+		case cgv::gui::EID_POSE:
+			cgv::gui::vr_pose_event& vrpe = static_cast<cgv::gui::vr_pose_event&>(e);
+			// check for controller pose events
+			int ci = vrpe.get_trackable_index();
+			if (ci != -1 && ci < 4) {
+				// the pose is recorded here and applied to grabbed boxes or used for picking by the interaction thread
+				interaction_event ie;
+				ie.kind = IE_POSE;
+				ie.ci = ci;
+				ie.time = get_time();
+				ie.position = vrpe.get_position();
+				ie.last_position = vrpe.get_last_position();
+				ie.orientation = quat(vrpe.get_orientation());
+				// get rotation from previous to current orientation
+				// this is the current orientation matrix times the
+				// inverse (or transpose) of last orientation matrix:
+				// vrpe.get_orientation()*transpose(vrpe.get_last_orientation())
+				ie.rotation = vrpe.get_rotation_matrix();
+				vrpe.get_state().controller[ci].put_ray(&ie.origin(0), &ie.direction(0));
+				interaction_events.push(ie);
+				post_redraw();
+			}
+			return true;
+		}
+		return false;
+	}
+	/// print the traced startup phases
+	void report_startup()
+	{
+		ref_startup_tracer().report(std::cout);
+	}
+	bool init(cgv::render::context& ctx)
+	{
+		startup_tracer::scope trace(ref_startup_tracer(), "init");
+		wait_for_scene();
+		start_interaction();
+		if (!cgv::utils::has_option("NO_OPENVR"))
+			ctx.set_gamma(1.0f);
+		// read the mesh off the critical path, it is uploaded in prepare_frame once available
+#ifdef _DEBUG
+		std::string mesh_file_name = "D:/data/surface/meshes/obj/Max-Planck_lowres.obj";
+#else
+		std::string mesh_file_name = "D:/data/surface/meshes/obj/Max-Planck_highres.obj";
+#endif
+		mesh_loading = std::async(std::launch::async, [this, mesh_file_name]() {
+			startup_tracer::scope trace_mesh(ref_startup_tracer(), "read mesh");
+			return loaded_mesh.read(mesh_file_name);
+		});
+		cgv::gui::connect_vr_server(true);
+
+		auto view_ptr = find_view_as_node();
+		if (view_ptr) {
+			view_ptr->set_eye_keep_view_angle(dvec3(0, 4, -4));
+			// if the view points to a vr_view_interactor
+			vr_view_ptr = dynamic_cast<vr_view_interactor*>(view_ptr);
+			if (vr_view_ptr) {
+				// configure vr event processing
+				vr_view_ptr->set_event_type_flags(
+					cgv::gui::VREventTypeFlags(
+						cgv::gui::VRE_KEY +
+						cgv::gui::VRE_THROTTLE +
+						cgv::gui::VRE_STICK +
+						cgv::gui::VRE_STICK_KEY +
+						cgv::gui::VRE_POSE
+					));
+				vr_view_ptr->enable_vr_event_debugging(false);
+				// configure vr rendering
+				vr_view_ptr->draw_action_zone(false);
+				vr_view_ptr->draw_vr_kits(true);
+				vr_view_ptr->enable_blit_vr_views(true);
+				vr_view_ptr->set_blit_vr_view_width(200);
+
+			}
+		}
+		startup_tracer::scope trace_renderers(ref_startup_tracer(), "init renderers");
+		cgv::render::ref_box_renderer(ctx, 1);
+		cgv::render::ref_sphere_renderer(ctx, 1);
+		static_aam.init(ctx);
+		lod_aam.init(ctx);
+		compact_aam.init(ctx);
+		movable_aam.init(ctx);
+		if (!compact_renderer.init(ctx) || !movable_compact_renderer.init(ctx))
+			std::cerr << "could not build compact_box.glpr, compact boxes are decoded for drawing" << std::endl;
+		return true;
+		}
+	void clear(cgv::render::context & ctx)
+	{
+		if (mesh_loading.valid())
+			mesh_loading.wait();
+		wait_for_scene();
+		MI.destruct(ctx);
+		environment_streamer.clear([&ctx](environment_tile& t) {
+			t.aam.destruct(ctx);
+			t.coarse_aam.destruct(ctx);
+		});
+		static_aam.destruct(ctx);
+		lod_aam.destruct(ctx);
+		compact_aam.destruct(ctx);
+		movable_aam.destruct(ctx);
+		compact_renderer.clear(ctx);
+		movable_compact_renderer.clear(ctx);
+		movable_color_vbo.destruct(ctx);
+		cgv::render::ref_box_renderer(ctx, -1);
+		cgv::render::ref_sphere_renderer(ctx, -1);
+	}
+	void init_frame(cgv::render::context & ctx)
+	{
+		prepare_frame(ctx);
+		const scene_state& S = scene_buffer.ref_front();
+
+		// label resources are created once the label quad is drawn the first time
+		if (label_positions.empty())
+			return;
+		if (label_fbo.is_created() && label_fbo.get_width() != label_resolution) {
+			label_tex.destruct(ctx);
+			label_fbo.destruct(ctx);
+		}
+		if (!label_fbo.is_created()) {
+			startup_tracer::scope trace(ref_startup_tracer(), "create label resources");
+			label_tex.create(ctx, cgv::render::TT_2D, label_resolution, label_resolution);
+			label_fbo.create(ctx, label_resolution, label_resolution);
+			label_tex.set_min_filter(cgv::render::TF_LINEAR_MIPMAP_LINEAR);
+			label_tex.set_mag_filter(cgv::render::TF_LINEAR);
+			label_fbo.attach(ctx, label_tex);
+			label_outofdate = true;
+		}
+		if (label_outofdate && label_fbo.is_complete(ctx)) {
+			glPushAttrib(GL_COLOR_BUFFER_BIT);
+			label_fbo.enable(ctx);
+			label_fbo.push_viewport(ctx);
+			ctx.push_pixel_coords();
+			glClearColor(0.5f, 0.5f, 0.5f, 1.0f);
+			glClear(GL_COLOR_BUFFER_BIT);
+
+			glColor4f(label_color[0], label_color[1], label_color[2], 1);
+			ctx.set_cursor(20, (int)ceil(label_size) + 20);
+			ensure_label_font();
+			ctx.enable_font_face(label_font_face, label_size);
+			ctx.output_stream() << label_text << "\n";
+			ctx.output_stream().flush(); // make sure to flush the stream before change of font size or font face
+
+			ctx.enable_font_face(label_font_face, 0.7f * label_size);
+			for (size_t i = 0; i < S.intersection_points.size(); ++i) {
+				ctx.output_stream()
+					<< "box " << S.intersection_box_indices[i]
+					<< " at (" << S.intersection_points[i]
+					<< ") with controller " << S.intersection_controller_indices[i] << "\n";
+			}
+			ctx.output_stream().flush();
+
+			ctx.pop_pixel_coords();
+			label_fbo.pop_viewport(ctx);
+			label_fbo.disable(ctx);
+			glPopAttrib();
+			label_outofdate = false;
+
+			label_tex.generate_mipmaps(ctx);
+		}
+	}
+	/// advance the frame once the main pass including all eye and blit views is finished
+	void after_finish(cgv::render::context& ctx)
+	{
+		if (ctx.get_render_pass() != cgv::render::RP_MAIN)
+			return;
+		++frame_index;
+		measure_frame_latency();
+		if (ref_startup_tracer().mark_first_frame()) {
+			time_to_first_frame_ms = ref_startup_tracer().get_first_frame_ms();
+			update_member(&time_to_first_frame_ms);
+		}
+	}
+	void draw(cgv::render::context & ctx)
+	{
+		const scene_state& S = scene_buffer.ref_front();
+		++nr_views;
+		if (!ray_positions.empty()) {
+			cgv::render::shader_program& prog = ctx.ref_default_shader_program();
+			int pi = prog.get_position_index();
+			int ci = prog.get_color_index();
+			cgv::render::attribute_array_binding::set_global_attribute_array(ctx, pi, ray_positions.data(), ray_positions.size());
+			cgv::render::attribute_array_binding::enable_global_array(ctx, pi);
+			cgv::render::attribute_array_binding::set_global_attribute_array(ctx, ci, ray_colors.data(), ray_colors.size());
+			cgv::render::attribute_array_binding::enable_global_array(ctx, ci);
+			glLineWidth(3);
+			prog.enable(ctx);
+			glDrawArrays(GL_LINES, 0, (GLsizei)ray_positions.size());
+			prog.disable(ctx);
+			cgv::render::attribute_array_binding::disable_global_array(ctx, pi);
+			cgv::render::attribute_array_binding::disable_global_array(ctx, ci);
+			glLineWidth(1);
+		}
+		// draw static boxes from the arrays uploaded for this frame
+		cgv::render::box_renderer& renderer = cgv::render::ref_box_renderer(ctx);
+		renderer.set_render_style(style);
+		vec3 viewer = get_viewer_position();
+		size_t nr_boxes = nr_static_boxes;
+		if (compact_static_boxes && !compact_boxes.empty() && compact_renderer.is_initialized()) {
+			compact_renderer.draw(ctx);
+			nr_boxes += compact_boxes.size();
+		}
+		else if (compact_static_boxes && !compact_boxes.empty()) {
+			renderer.enable_attribute_array_manager(ctx, compact_aam);
+			if (renderer.validate_and_enable(ctx)) {
+				glDrawArrays(GL_POINTS, 0, (GLsizei)compact_boxes.size());
+			}
+			renderer.disable(ctx);
+			renderer.disable_attribute_array_manager(ctx, compact_aam);
+			nr_boxes += compact_boxes.size();
+		}
+		renderer.enable_attribute_array_manager(ctx, static_aam);
+		if (renderer.validate_and_enable(ctx)) {
+			for (const auto& r : lod_fine_ranges)
+				glDrawArrays(GL_POINTS, r.first, r.count);
+		}
+		renderer.disable(ctx);
+		renderer.disable_attribute_array_manager(ctx, static_aam);
+		if (!lod_coarse_ranges.empty()) {
+			renderer.enable_attribute_array_manager(ctx, lod_aam);
+			if (renderer.validate_and_enable(ctx)) {
+				for (const auto& r : lod_coarse_ranges)
+					glDrawArrays(GL_POINTS, r.first, r.count);
+			}
+			renderer.disable(ctx);
+			renderer.disable_attribute_array_manager(ctx, lod_aam);
+		}
+
+		// draw resident environment tiles from their gpu storage
+		for (const auto& r : environment_streamer.get_resident_tiles()) {
+			environment_tile& t = *r.second;
+			bool coarse = far_field_lod && heightfield_lod::get_distance(t.bounds, viewer) >= lod_distance;
+			cgv::render::attribute_array_manager& aam = coarse ? t.coarse_aam : t.aam;
+			renderer.enable_attribute_array_manager(ctx, aam);
+			if (renderer.validate_and_enable(ctx)) {
+				glDrawArrays(GL_POINTS, 0, (GLsizei)(coarse ? t.coarse_boxes.size() : t.boxes.size()));
+			}
+			renderer.disable(ctx);
+			renderer.disable_attribute_array_manager(ctx, aam);
+			nr_boxes += coarse ? t.coarse_boxes.size() : t.boxes.size();
+		}
+		if (nr_drawn_boxes != (unsigned)nr_boxes) {
+			nr_drawn_boxes = (unsigned)nr_boxes;
+			update_member(&nr_drawn_boxes);
+		}
+
+		// draw dynamic boxes 
+		if (compact_movable_boxes && movable_compact_renderer.is_initialized())
+			movable_compact_renderer.draw(ctx);
+		else {
+			renderer.set_render_style(movable_style);
+			renderer.enable_attribute_array_manager(ctx, movable_aam);
+			if (renderer.validate_and_enable(ctx)) {
+				glDrawArrays(GL_POINTS, 0, (GLsizei)movable_boxes.size());
+			}
+			renderer.disable(ctx);
+			renderer.disable_attribute_array_manager(ctx, movable_aam);
+		}
+
+		// draw landing preview of grabbed boxes
+		if (!S.preview_boxes.empty()) {
+			renderer.set_render_style(movable_style);
+			renderer.set_box_array(ctx, S.preview_boxes);
+			renderer.set_color_array(ctx, S.preview_colors);
+			renderer.set_translation_array(ctx, S.preview_translations);
+			renderer.set_rotation_array(ctx, S.preview_rotations);
+			if (renderer.validate_and_enable(ctx)) {
+				glDrawArrays(GL_POINTS, 0, (GLsizei)S.preview_boxes.size());
+			}
+			renderer.disable(ctx);
+		}
+
+		// draw intersection points
+		if (!S.intersection_points.empty()) {
+			auto& sr = cgv::render::ref_sphere_renderer(ctx);
+			sr.set_position_array(ctx, predicted_points);
+			sr.set_color_array(ctx, S.intersection_colors);
+			sr.set_render_style(srs);
+			if (sr.validate_and_enable(ctx)) {
+				glDrawArrays(GL_POINTS, 0, (GLsizei)S.intersection_points.size());
+				sr.disable(ctx);
+			}
+		}
+
+		// draw label
+		if (label_tex.is_created() && !label_positions.empty()) {
+			cgv::render::shader_program& prog = ctx.ref_default_shader_program(true);
+			int pi = prog.get_position_index();
+			int ti = prog.get_texcoord_index();
+			cgv::render::attribute_array_binding::set_global_attribute_array(ctx, pi, label_positions.data(), label_positions.size());
+			cgv::render::attribute_array_binding::enable_global_array(ctx, pi);
+			cgv::render::attribute_array_binding::set_global_attribute_array(ctx, ti, label_texcoords.data(), label_texcoords.size());
+			cgv::render::attribute_array_binding::enable_global_array(ctx, ti);
+			prog.enable(ctx);
+			label_tex.enable(ctx);
+			ctx.set_color(rgb(1, 1, 1));
+			glDrawArrays(GL_TRIANGLE_STRIP, 0, (GLsizei)label_positions.size());
+			label_tex.disable(ctx);
+			prog.disable(ctx);
+			cgv::render::attribute_array_binding::disable_global_array(ctx, pi);
+			cgv::render::attribute_array_binding::disable_global_array(ctx, ti);
+		}
+	}
+	};
+
+/// construct boxes that represent a table of dimensions tw,td,th and leg width tW
+void natural_interfaces::construct_table(float tw, float td, float th, float tW)
+{
+	// construct table
+	rgb table_clr(0.3f, 0.2f, 0.0f);
+	boxes.push_back(box3(
+		vec3(-0.5f * tw - 2 * tW, th, -0.5f * td - 2 * tW),
+		vec3(0.5f * tw + 2 * tW, th + tW, 0.5f * td + 2 * tW)));
+	box_colors.push_back(table_clr);
+
+	boxes.push_back(box3(vec3(-0.5f * tw, 0, -0.5f * td), vec3(-0.5f * tw - tW, th, -0.5f * td - tW)));
+	boxes.push_back(box3(vec3(-0.5f * tw, 0, 0.5f * td), vec3(-0.5f * tw - tW, th, 0.5f * td + tW)));
+	boxes.push_back(box3(vec3(0.5f * tw, 0, -0.5f * td), vec3(0.5f * tw + tW, th, -0.5f * td - tW)));
+	boxes.push_back(box3(vec3(0.5f * tw, 0, 0.5f * td), vec3(0.5f * tw + tW, th, 0.5f * td + tW)));
+	box_colors.push_back(table_clr);
+	box_colors.push_back(table_clr);
+	box_colors.push_back(table_clr);
+	box_colors.push_back(table_clr);
+}
+/// construct boxes that represent a room of dimensions w,d,h and wall width W
+void natural_interfaces::construct_room(float w, float d, float h, float W, bool walls, bool ceiling)
+{
+	// construct floor
+	boxes.push_back(box3(vec3(-0.5f * w, -W, -0.5f * d), vec3(0.5f * w, 0, 0.5f * d)));
+	box_colors.push_back(rgb(0.2f, 0.2f, 0.2f));
+
+	if (walls) {
+		// construct walls
+		boxes.push_back(box3(vec3(-0.5f * w, -W, -0.5f * d - W), vec3(0.5f * w, h, -0.5f * d)));
+		box_colors.push_back(rgb(0.8f, 0.5f, 0.5f));
+		boxes.push_back(box3(vec3(-0.5f * w, -W, 0.5f * d), vec3(0.5f * w, h, 0.5f * d + W)));
+		box_colors.push_back(rgb(0.8f, 0.5f, 0.5f));
+
+		boxes.push_back(box3(vec3(0.5f * w, -W, -0.5f * d - W), vec3(0.5f * w + W, h, 0.5f * d + W)));
+		box_colors.push_back(rgb(0.5f, 0.8f, 0.5f));
+	}
+	if (ceiling) {
+		// construct ceiling
+		boxes.push_back(box3(vec3(-0.5f * w - W, h, -0.5f * d - W), vec3(0.5f * w + W, h + W, 0.5f * d + W)));
+		box_colors.push_back(rgb(0.5f, 0.5f, 0.8f));
+	}
+}
+
+#include <random>
+
+/// construct boxes for environment
+void natural_interfaces::construct_environment(float s, float ew, float ed, float eh, float w, float d, float h)
+{
+	std::default_random_engine generator;
+	std::uniform_real_distribution<float> distribution(0, 1);
+	unsigned n = unsigned(ew / s);
+	unsigned m = unsigned(ed / s);
+	for (unsigned i = 0; i < n; ++i) {
+		float x = i * s - 0.5f * ew;
+		for (unsigned j = 0; j < m; ++j) {
+			float z = j * s - 0.5f * ed;
+			if ((x + 0.5f * s > -0.5f * w && x < 0.5f * w) && (z + 0.5f * s > -0.5f * d && z < 0.5f * d))
+				continue;
+			float h = 0.2f * (std::max(abs(x) - 0.5f * w, 0.0f) + std::max(abs(z) - 0.5f * d, 0.0f)) * distribution(generator) + 0.1f;
+			boxes.push_back(box3(vec3(x, 0, z), vec3(x + s, h, z + s)));
+			box_colors.push_back(
+				rgb(0.3f * distribution(generator) + 0.3f,
+					0.3f * distribution(generator) + 0.2f,
+					0.2f * distribution(generator) + 0.1f));
+		}
+	}
+}
+
+/// construct boxes of the environment tile t with n x n cells of size s outside the room of dimensions w,d
+void natural_interfaces::construct_environment_tile(environment_tile& t, float s, unsigned n, float w, float d, float max_height)
+{
+	// seed with tile coordinates such that a tile looks the same whenever it is streamed in again
+	std::default_random_engine generator(unsigned(t.i) * 73856093u ^ unsigned(t.j) * 19349663u);
+	std::uniform_real_distribution<float> distribution(0, 1);
+	t.cell_boxes.assign(n * n, -1);
+	for (unsigned b = 0; b < n; ++b) {
+		float z = (t.j * (int)n + (int)b) * s;
+		for (unsigned a = 0; a < n; ++a) {
+			float x = (t.i * (int)n + (int)a) * s;
+			if ((x + 0.5f * s > -0.5f * w && x < 0.5f * w) && (z + 0.5f * s > -0.5f * d && z < 0.5f * d))
+				continue;
+			float h = std::min(0.2f * (std::max(abs(x) - 0.5f * w, 0.0f) + std::max(abs(z) - 0.5f * d, 0.0f)) * distribution(generator) + 0.1f, max_height);
+			t.cell_boxes[b * n + a] = (int)t.boxes.size();
+			t.boxes.push_back(box3(vec3(x, 0, z), vec3(x + s, h, z + s)));
+			t.colors.push_back(
+				rgb(0.3f * distribution(generator) + 0.3f,
+					0.3f * distribution(generator) + 0.2f,
+					0.2f * distribution(generator) + 0.1f));
+		}
+	}
+}
+
+/// read environment tile t with n x n cells from directory dir and return whether this succeeded
+bool natural_interfaces::read_environment_tile(const std::string& dir, unsigned n, environment_tile& t)
+{
+	// file layout: number of boxes, boxes, colors, number of cells, cell box indices
+	std::ifstream is(dir + "/tile_" + cgv::utils::to_string(t.i) + "_" + cgv::utils::to_string(t.j) + ".bin", std::ios::binary);
+	if (is.fail())
+		return false;
+	uint32_t nr_boxes, nr_cells;
+	is.read(reinterpret_cast<char*>(&nr_boxes), sizeof(nr_boxes));
+	t.boxes.resize(nr_boxes);
+	t.colors.resize(nr_boxes);
+	is.read(reinterpret_cast<char*>(t.boxes.data()), nr_boxes * sizeof(box3));
+	is.read(reinterpret_cast<char*>(t.colors.data()), nr_boxes * sizeof(rgb));
+	is.read(reinterpret_cast<char*>(&nr_cells), sizeof(nr_cells));
+	if (is.fail() || nr_cells != n * n) {
+		t.boxes.clear();
+		t.colors.clear();
+		return false;
+	}
+	t.cell_boxes.resize(nr_cells);
+	is.read(reinterpret_cast<char*>(t.cell_boxes.data()), nr_cells * sizeof(int));
+	for (int bi : t.cell_boxes)
+		if (bi < -1 || bi >= (int)nr_boxes)
+			is.setstate(std::ios::failbit);
+	if (is.fail()) {
+		t.boxes.clear();
+		t.colors.clear();
+		t.cell_boxes.clear();
+		return false;
+	}
+	return true;
+}
+
+/// construct boxes that can be moved around
+void natural_interfaces::construct_movable_boxes(float tw, float td, float th, float tW, size_t nr)
+{
+	std::default_random_engine generator;
+	std::uniform_real_distribution<float> distribution(0, 1);
+	std::uniform_real_distribution<float> signed_distribution(-1, 1);
+	for (size_t i = 0; i < nr; ++i) {
+		float x = distribution(generator);
+		float y = distribution(generator);
+		vec3 extent(distribution(generator), distribution(generator), distribution(generator));
+		extent += 0.1f;
+		extent *= std::min(tw, td) * 0.2f;
+
+		vec3 center(-0.5f * tw + x * tw, th + tW, -0.5f * td + y * td);
+		movable_boxes.push_back(box3(-0.5f * extent, 0.5f * extent));
+		movable_box_colors.push_back(rgb(distribution(generator), distribution(generator), distribution(generator)));
+		movable_box_translations.push_back(center);
+		quat rot(signed_distribution(generator), signed_distribution(generator), signed_distribution(generator), signed_distribution(generator));
+		rot.normalize();
+		movable_box_rotations.push_back(rot);
+	}
+}
+
+#include <cgv/base/register.h>
+
+cgv::base::object_registration<natural_interfaces> natural_interfaces_reg("");
+
 ///@}
\ No newline at end of file
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cgv/render/render_types.h>
+#include <cmath>
+#include <algorithm>
+
+///@ingroup NI
+///@{
+
+/**@file
+   short history of tracked poses used to extrapolate them to the time at which a frame is displayed
+*/
+
+/// ring buffer of time stamped poses with constant velocity extrapolation of position and orientation
+class pose_history : public cgv::render::render_types
+{
+public:
+	/// time stamped pose
+	struct sample
+	{
+		double time;
+		vec3 position;
+		quat orientation;
+	};
+	/// maximum number of kept samples
+	static const unsigned capacity = 8;
+protected:
+	sample samples[capacity];
+	unsigned count, next;
+	/// return the k-th latest sample, where k = 0 is the latest
+	const sample& get_sample(unsigned k) const { return samples[(next + capacity - 1 - k) % capacity]; }
+public:
+	/// construct empty history
+	pose_history() : count(0), next(0) {}
+	/// remove all samples
+	void clear() { count = next = 0; }
+	/// return whether no sample is stored
+	bool empty() const { return count == 0; }
+	/// add a new sample
+	void add(double time, const vec3& position, const quat& orientation)
+	{
+		samples[next].time = time;
+		samples[next].position = position;
+		samples[next].orientation = orientation;
+		next = (next + 1) % capacity;
+		if (count < capacity)
+			++count;
+	}
+	/// return latest sample, must not be called on an empty history
+	const sample& latest() const { return get_sample(0); }
+	/// extrapolate the pose to the given time with velocities estimated over the last window samples, looking ahead at most max_ahead seconds;
+	/// returns the time the resulting pose corresponds to, which is earlier than time if the look ahead was clamped
+	double predict(double time, unsigned window, double max_ahead, vec3& position, quat& orientation) const
+	{
+		const sample& s1 = latest();
+		position = s1.position;
+		orientation = s1.orientation;
+		unsigned k = std::min(std::max(window, 1u), count - 1);
+		if (k == 0)
+			return s1.time;
+		const sample& s0 = get_sample(k);
+		double dt = s1.time - s0.time;
+		if (dt <= 0)
+			return s1.time;
+		float ahead = (float)std::min(std::max(time - s1.time, 0.0), max_ahead);
+		float f = ahead / (float)dt;
+		position += f * (s1.position - s0.position);
+		// relative rotation from s0 to s1 taking the shorter way
+		quat dq = s1.orientation * s0.orientation.conj();
+		vec3 axis = dq.im();
+		float w = dq.re();
+		if (w < 0) {
+			axis = -axis;
+			w = -w;
+		}
+		float s = axis.length();
+		if (s >= 1e-7f) {
+			float angle = 2.0f * atan2(s, w);
+			orientation = quat(axis / s, f * angle) * orientation;
+		}
+		return s1.time + ahead;
+	}
+};
+
+///@}
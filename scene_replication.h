@@ -0,0 +1,779 @@
+#pragma once
+
+#include "compact_boxes.h"
+#include <vector>
+#include <map>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#ifdef _MSC_VER
+#pragma comment(lib, "ws2_32.lib")
+#endif
+#else
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+///@ingroup NI
+///@{
+
+/**@file
+   replication of quantized box transforms between viewer instances through a relay on the same machine
+*/
+
+/// non blocking udp socket bound to the loopback interface
+class loopback_socket
+{
+protected:
+#ifdef _WIN32
+	SOCKET handle;
+	static bool is_valid(SOCKET s) { return s != INVALID_SOCKET; }
+#else
+	int handle;
+	static bool is_valid(int s) { return s != -1; }
+#endif
+	uint16_t port;
+	/// return address on the loopback interface
+	static sockaddr_in get_address(uint16_t port)
+	{
+		sockaddr_in address;
+		std::memset(&address, 0, sizeof(address));
+		address.sin_family = AF_INET;
+		address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+		address.sin_port = htons(port);
+		return address;
+	}
+public:
+	/// construct closed socket
+	loopback_socket() : port(0)
+	{
+#ifdef _WIN32
+		handle = INVALID_SOCKET;
+#else
+		handle = -1;
+#endif
+	}
+	/// close on destruction
+	~loopback_socket() { close(); }
+	/// bind to the given port or to a free port if 0 is passed
+	bool open(uint16_t _port = 0)
+	{
+		close();
+#ifdef _WIN32
+		static bool initialized = false;
+		if (!initialized) {
+			WSADATA data;
+			if (WSAStartup(MAKEWORD(2, 2), &data) != 0)
+				return false;
+			initialized = true;
+		}
+#endif
+		handle = socket(AF_INET, SOCK_DGRAM, 0);
+		if (!is_valid(handle))
+			return false;
+		sockaddr_in address = get_address(_port);
+		socklen_t length = sizeof(address);
+		if (bind(handle, (sockaddr*)&address, sizeof(address)) != 0 ||
+			getsockname(handle, (sockaddr*)&address, &length) != 0) {
+			close();
+			return false;
+		}
+		port = ntohs(address.sin_port);
+#ifdef _WIN32
+		u_long non_blocking = 1;
+		ioctlsocket(handle, FIONBIO, &non_blocking);
+#else
+		fcntl(handle, F_SETFL, fcntl(handle, F_GETFL, 0) | O_NONBLOCK);
+#endif
+		return true;
+	}
+	/// close socket
+	void close()
+	{
+		if (!is_valid(handle))
+			return;
+#ifdef _WIN32
+		closesocket(handle);
+		handle = INVALID_SOCKET;
+#else
+		::close(handle);
+		handle = -1;
+#endif
+		port = 0;
+	}
+	/// return whether socket is open
+	bool is_open() const { return is_valid(handle); }
+	/// return bound port
+	uint16_t get_port() const { return port; }
+	/// send datagram to the given port
+	bool send_to(uint16_t to_port, const std::vector<uint8_t>& data)
+	{
+		sockaddr_in address = get_address(to_port);
+		return sendto(handle, (const char*)data.data(), (int)data.size(), 0, (sockaddr*)&address, sizeof(address)) == (int)data.size();
+	}
+	/// receive next datagram if available and return its size or 0
+	size_t receive(std::vector<uint8_t>& data, uint16_t& from_port)
+	{
+		data.resize(2048);
+		sockaddr_in address;
+		socklen_t length = sizeof(address);
+		int size = (int)recvfrom(handle, (char*)data.data(), (int)data.size(), 0, (sockaddr*)&address, &length);
+		if (size <= 0) {
+			data.clear();
+			return 0;
+		}
+		data.resize(size);
+		from_port = ntohs(address.sin_port);
+		return size;
+	}
+};
+
+/// kinds of datagrams
+enum ReplicationMessage
+{
+	RM_HELLO = 1, // client registers at the relay
+	RM_UPDATE,    // changed transforms
+	RM_ACK,       // acknowledgment of an update
+	RM_BYE        // client leaves
+};
+
+/// unsigned integer with the size of a serialized value
+template <size_t N> struct replication_word;
+template <> struct replication_word<1> { typedef uint8_t type; };
+template <> struct replication_word<2> { typedef uint16_t type; };
+template <> struct replication_word<4> { typedef uint32_t type; };
+template <> struct replication_word<8> { typedef uint64_t type; };
+
+/// appends and reads little endian values and variable length integers to and from datagrams, values are converted byte by byte
+/// such that hosts of different byte order can share the relay
+struct replication_packet
+{
+	std::vector<uint8_t> data;
+	size_t read_pos;
+	replication_packet() : read_pos(0) {}
+	void clear() { data.clear(); read_pos = 0; }
+	template <typename T>
+	void put(const T& value)
+	{
+		typename replication_word<sizeof(T)>::type word;
+		std::memcpy(&word, &value, sizeof(T));
+		for (size_t b = 0; b < sizeof(T); ++b)
+			data.push_back(uint8_t(uint64_t(word) >> (8 * b)));
+	}
+	void put_varint(uint32_t value)
+	{
+		while (value >= 0x80) {
+			data.push_back(uint8_t(value | 0x80));
+			value >>= 7;
+		}
+		data.push_back(uint8_t(value));
+	}
+	template <typename T>
+	bool get(T& value)
+	{
+		if (read_pos + sizeof(T) > data.size())
+			return false;
+		uint64_t bits = 0;
+		for (size_t b = 0; b < sizeof(T); ++b)
+			bits |= uint64_t(data[read_pos + b]) << (8 * b);
+		typename replication_word<sizeof(T)>::type word = typename replication_word<sizeof(T)>::type(bits);
+		std::memcpy(&value, &word, sizeof(T));
+		read_pos += sizeof(T);
+		return true;
+	}
+	bool get_varint(uint32_t& value)
+	{
+		value = 0;
+		for (int shift = 0; shift < 35; shift += 7) {
+			uint8_t byte;
+			if (!get(byte))
+				return false;
+			value |= uint32_t(byte & 0x7f) << shift;
+			if ((byte & 0x80) == 0)
+				return true;
+		}
+		return false;
+	}
+};
+
+/// one changed transform
+struct replicated_entry
+{
+	uint32_t index;
+	compact_transform transform;
+};
+
+/// return whether two quantized transforms are identical
+inline bool operator == (const compact_transform& a, const compact_transform& b)
+{
+	return a.translation[0] == b.translation[0] && a.translation[1] == b.translation[1] &&
+		a.translation[2] == b.translation[2] && a.rotation == b.rotation;
+}
+inline bool operator != (const compact_transform& a, const compact_transform& b) { return !(a == b); }
+
+/// writes update datagrams holding only the transforms that differ from the state acknowledged by the receiver, unacknowledged entries are resent after a timeout;
+/// only entries marked as changed and entries of datagrams that were not acknowledged in time are examined, so the cost does not grow with the table
+class delta_sender
+{
+protected:
+	/// datagram waiting for its acknowledgment
+	struct pending_datagram
+	{
+		double time;
+		std::vector<replicated_entry> entries;
+	};
+	// state confirmed by the receiver and whether an entry has ever been confirmed
+	std::vector<compact_transform> acked;
+	std::vector<uint8_t> acked_valid;
+	// last sent value and time per entry
+	std::vector<compact_transform> sent;
+	std::vector<double> sent_time;
+	// unacknowledged datagrams by sequence number
+	std::map<uint32_t, pending_datagram> pending;
+	uint32_t next_sequence;
+	// entries marked as changed since the last write, each listed once
+	std::vector<uint32_t> marked;
+	std::vector<uint8_t> marked_listed;
+	std::vector<uint32_t> changed;
+	/// grow per entry arrays to hold entry i
+	void reserve_entry(uint32_t i)
+	{
+		if (i < acked.size())
+			return;
+		acked.resize(i + 1);
+		acked_valid.resize(i + 1, 0);
+		sent.resize(i + 1);
+		sent_time.resize(i + 1, -1e10);
+		marked_listed.resize(i + 1, 0);
+	}
+	/// mark the entries of a dropped or expired datagram that were not sent again since, such that they are resent by the next write
+	void remark(const pending_datagram& d)
+	{
+		for (const replicated_entry& e : d.entries)
+			if (sent_time[e.index] == d.time) {
+				sent_time[e.index] = -1e10;
+				mark_changed(e.index);
+			}
+	}
+public:
+	/// maximum number of entries per datagram keeping datagrams below 1200 bytes
+	static const unsigned max_entries = 64;
+	/// construct sender for an empty table
+	delta_sender() : next_sequence(1) {}
+	/// forget all acknowledged state
+	void reset()
+	{
+		acked.clear();
+		acked_valid.clear();
+		sent.clear();
+		sent_time.clear();
+		pending.clear();
+		marked.clear();
+		marked_listed.clear();
+	}
+	/// mark entry i to be examined by the next write_updates
+	void mark_changed(uint32_t i)
+	{
+		reserve_entry(i);
+		if (marked_listed[i])
+			return;
+		marked_listed[i] = 1;
+		marked.push_back(i);
+	}
+	/// mark the first n entries, e.g. to send a complete table to a new receiver
+	void mark_all_changed(uint32_t n)
+	{
+		for (uint32_t i = 0; i < n; ++i)
+			mark_changed(i);
+	}
+	/// append update datagrams for the marked entries of current and the entries of datagrams unacknowledged for resend_timeout that differ
+	/// from the acknowledged state and have not been sent within resend_timeout; send_time is written into each datagram and returned by
+	/// acknowledgments; returns number of written entries
+	size_t write_updates(const std::vector<compact_transform>& current, double now, double resend_timeout, double send_time, std::vector<replication_packet>& packets)
+	{
+		// entries of expired datagrams are examined again, the datagrams are superseded by the resent entries
+		while (!pending.empty() && now - pending.begin()->second.time >= resend_timeout) {
+			remark(pending.begin()->second);
+			pending.erase(pending.begin());
+		}
+		changed.clear();
+		for (uint32_t i : marked) {
+			marked_listed[i] = 0;
+			if (i >= current.size())
+				continue;
+			if (acked_valid[i] && acked[i] == current[i])
+				continue;
+			// entries sent recently stay in their pending datagram until it is acknowledged or expires
+			if (sent[i] == current[i] && now - sent_time[i] < resend_timeout)
+				continue;
+			changed.push_back(i);
+		}
+		marked.clear();
+		// indices are sent as increasing gaps
+		std::sort(changed.begin(), changed.end());
+		for (size_t begin = 0; begin < changed.size(); begin += max_entries) {
+			size_t end = std::min(begin + max_entries, changed.size());
+			uint32_t sequence = next_sequence++;
+			pending_datagram& d = pending[sequence];
+			d.time = now;
+			std::vector<replicated_entry>& entries = d.entries;
+			packets.push_back(replication_packet());
+			replication_packet& p = packets.back();
+			p.put(uint8_t(RM_UPDATE));
+			p.put(sequence);
+			p.put(send_time);
+			p.put(uint16_t(end - begin));
+			uint32_t last_index = 0;
+			for (size_t k = begin; k < end; ++k) {
+				uint32_t i = changed[k];
+				const compact_transform& c = current[i];
+				// indices are increasing and sent as gaps
+				p.put_varint(i - last_index);
+				last_index = i;
+				for (int j = 0; j < 3; ++j)
+					p.put(c.translation[j]);
+				p.put(c.rotation);
+				replicated_entry e = { i, c };
+				entries.push_back(e);
+				sent[i] = c;
+				sent_time[i] = now;
+			}
+		}
+		// the oldest datagrams are dropped if too many wait for acknowledgment, their entries are examined again in the next write
+		while (pending.size() > 256) {
+			remark(pending.begin()->second);
+			pending.erase(pending.begin());
+		}
+		return changed.size();
+	}
+	/// mark the entries of the datagram with the given sequence number as received; they are examined again as the current state may
+	/// have changed while the datagram was in flight; older datagrams were lost or reordered, so their entries are resent
+	void acknowledge(uint32_t sequence)
+	{
+		auto iter = pending.find(sequence);
+		if (iter == pending.end())
+			return;
+		for (const replicated_entry& e : iter->second.entries) {
+			set_acked(e.index, e.transform);
+			mark_changed(e.index);
+		}
+		for (auto older = pending.begin(); older != iter; ++older)
+			remark(older->second);
+		pending.erase(pending.begin(), ++iter);
+	}
+	/// declare that the receiver already knows the transform of entry i
+	void set_acked(uint32_t i, const compact_transform& c)
+	{
+		reserve_entry(i);
+		acked[i] = c;
+		acked_valid[i] = 1;
+	}
+	/// return whether transform i equals the acknowledged one
+	bool is_acked(uint32_t i, const compact_transform& c) const { return i < acked.size() && acked_valid[i] && acked[i] == c; }
+};
+
+/// parse an update datagram after its type byte and call on_entry(index, transform) for each entry
+template <typename entry_func>
+bool read_update(replication_packet& p, uint32_t& sequence, double& send_time, entry_func on_entry)
+{
+	uint16_t nr_entries;
+	if (!p.get(sequence) || !p.get(send_time) || !p.get(nr_entries))
+		return false;
+	uint32_t index = 0;
+	for (uint16_t k = 0; k < nr_entries; ++k) {
+		uint32_t gap;
+		compact_transform c;
+		if (!p.get_varint(gap) || !p.get(c.translation[0]) || !p.get(c.translation[1]) || !p.get(c.translation[2]) || !p.get(c.rotation))
+			return false;
+		index += gap;
+		on_entry(index, c);
+	}
+	return true;
+}
+/// write acknowledgment of an update datagram
+inline void write_ack(uint32_t sequence, double send_time, replication_packet& p)
+{
+	p.clear();
+	p.put(uint8_t(RM_ACK));
+	p.put(sequence);
+	p.put(send_time);
+}
+/// return seconds of a clock shared by all processes of the machine
+inline double get_replication_time()
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/// counters of a replication endpoint
+struct replication_statistics
+{
+	uint64_t bytes_sent;
+	uint64_t bytes_received;
+	uint64_t packets_sent;
+	uint64_t packets_received;
+	uint64_t entries_sent;
+	uint64_t entries_received;
+	// smoothed round trip time from sending an update to its acknowledgment
+	double round_trip_ms;
+	// smoothed time from the originating client sending a change to its arrival here
+	double latency_ms;
+};
+
+/// relay that keeps the authoritative transforms, acknowledges updates of clients and forwards changes to all other clients; runs on its own thread and can be hosted by any process on the machine
+class replication_relay
+{
+protected:
+	struct client
+	{
+		delta_sender sender;
+		// send time of the latest update received from any other client, forwarded to measure latency
+		double origin_time;
+	};
+	loopback_socket socket;
+	std::vector<compact_transform> state;
+	std::map<uint16_t, client> clients;
+	std::thread thread;
+	std::atomic<bool> running;
+	double resend_timeout;
+	/// receive all pending datagrams and forward changes
+	void run()
+	{
+		replication_packet p, ack;
+		std::vector<replication_packet> packets;
+		while (running) {
+			bool idle = true;
+			uint16_t from;
+			while (socket.receive(p.data, from) > 0) {
+				idle = false;
+				p.read_pos = 0;
+				uint8_t type;
+				if (!p.get(type))
+					continue;
+				if (type == RM_HELLO) {
+					// a new client receives the complete state
+					clients[from].origin_time = 0;
+					clients[from].sender.mark_all_changed(uint32_t(state.size()));
+				}
+				else if (type == RM_BYE)
+					clients.erase(from);
+				else if (type == RM_ACK) {
+					uint32_t sequence;
+					if (p.get(sequence) && clients.find(from) != clients.end())
+						clients[from].sender.acknowledge(sequence);
+				}
+				else if (type == RM_UPDATE) {
+					auto iter = clients.find(from);
+					if (iter == clients.end())
+						continue;
+					uint32_t sequence;
+					double send_time;
+					bool ok = read_update(p, sequence, send_time, [&](uint32_t i, const compact_transform& c) {
+						if (i >= state.size())
+							state.resize(i + 1);
+						state[i] = c;
+						// the sender already has this state while all other clients have to receive it
+						for (auto& other : clients)
+							if (other.first == from)
+								other.second.sender.set_acked(i, c);
+							else
+								other.second.sender.mark_changed(i);
+					});
+					if (!ok)
+						continue;
+					write_ack(sequence, send_time, ack);
+					socket.send_to(from, ack.data);
+					for (auto& c : clients)
+						if (c.first != from)
+							c.second.origin_time = std::max(c.second.origin_time, send_time);
+				}
+			}
+			double now = get_replication_time();
+			for (auto& c : clients) {
+				packets.clear();
+				c.second.sender.write_updates(state, now, resend_timeout, c.second.origin_time, packets);
+				for (const auto& q : packets)
+					socket.send_to(c.first, q.data);
+				// resent entries do not carry an origin time such that they are excluded from latency measurement
+				if (!packets.empty())
+					c.second.origin_time = 0;
+			}
+			if (idle)
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+	}
+public:
+	/// construct stopped relay
+	replication_relay() : running(false), resend_timeout(0.1) {}
+	/// stop on destruction
+	~replication_relay() { stop(); }
+	/// bind to port and start relaying
+	bool start(uint16_t port)
+	{
+		stop();
+		if (!socket.open(port))
+			return false;
+		state.clear();
+		clients.clear();
+		running = true;
+		thread = std::thread(&replication_relay::run, this);
+		return true;
+	}
+	/// stop relaying
+	void stop()
+	{
+		running = false;
+		if (thread.joinable())
+			thread.join();
+		socket.close();
+	}
+	/// return whether relay is running
+	bool is_running() const { return running; }
+	/// return bound port
+	uint16_t get_port() const { return socket.get_port(); }
+};
+
+/// endpoint of a viewer instance that sends its local changes to the relay and receives the changes of other instances
+class replication_client
+{
+protected:
+	loopback_socket socket;
+	uint16_t relay_port;
+	delta_sender sender;
+	replication_statistics statistics;
+	replication_packet p, ack;
+	std::vector<replication_packet> packets;
+	double resend_timeout;
+	/// blend new measurement into smoothed value
+	static void smooth(double& value, double sample) { value = value == 0 ? sample : 0.9 * value + 0.1 * sample; }
+public:
+	/// construct disconnected client
+	replication_client() : relay_port(0), resend_timeout(0.1) { std::memset(&statistics, 0, sizeof(statistics)); }
+	/// leave relay on destruction
+	~replication_client() { disconnect(); }
+	/// register at the relay listening on the given port
+	bool connect(uint16_t _relay_port)
+	{
+		disconnect();
+		if (!socket.open())
+			return false;
+		relay_port = _relay_port;
+		sender.reset();
+		std::memset(&statistics, 0, sizeof(statistics));
+		p.clear();
+		p.put(uint8_t(RM_HELLO));
+		socket.send_to(relay_port, p.data);
+		return true;
+	}
+	/// leave relay
+	void disconnect()
+	{
+		if (!socket.is_open())
+			return;
+		p.clear();
+		p.put(uint8_t(RM_BYE));
+		socket.send_to(relay_port, p.data);
+		socket.close();
+	}
+	/// return whether connected
+	bool is_connected() const { return socket.is_open(); }
+	/// mark local transform i as changed such that the next send examines it
+	void mark_changed(uint32_t i) { sender.mark_changed(i); }
+	/// mark the first n local transforms as changed, e.g. to announce the complete table after connecting
+	void mark_all_changed(uint32_t n) { sender.mark_all_changed(n); }
+	/// send marked local transforms and unacknowledged transforms that differ from the state known to the relay
+	void send(const std::vector<compact_transform>& local)
+	{
+		if (!socket.is_open())
+			return;
+		double now = get_replication_time();
+		packets.clear();
+		statistics.entries_sent += sender.write_updates(local, now, resend_timeout, now, packets);
+		for (const auto& q : packets) {
+			if (socket.send_to(relay_port, q.data)) {
+				statistics.bytes_sent += q.data.size();
+				++statistics.packets_sent;
+			}
+		}
+	}
+	/// process all received datagrams and call on_remote(index, transform) for each changed transform of other instances; returns number of received changes
+	template <typename remote_func>
+	size_t receive(remote_func on_remote)
+	{
+		size_t count = 0;
+		if (!socket.is_open())
+			return count;
+		uint16_t from;
+		while (socket.receive(p.data, from) > 0) {
+			p.read_pos = 0;
+			statistics.bytes_received += p.data.size();
+			++statistics.packets_received;
+			uint8_t type;
+			if (!p.get(type))
+				continue;
+			if (type == RM_ACK) {
+				uint32_t sequence;
+				double send_time;
+				if (p.get(sequence) && p.get(send_time)) {
+					sender.acknowledge(sequence);
+					smooth(statistics.round_trip_ms, 1000.0 * (get_replication_time() - send_time));
+				}
+			}
+			else if (type == RM_UPDATE) {
+				uint32_t sequence;
+				double send_time;
+				bool ok = read_update(p, sequence, send_time, [&](uint32_t i, const compact_transform& c) {
+					// the relay already has this state, so it is not sent back
+					sender.set_acked(i, c);
+					on_remote(i, c);
+					++count;
+				});
+				if (!ok)
+					continue;
+				if (send_time > 0)
+					smooth(statistics.latency_ms, 1000.0 * (get_replication_time() - send_time));
+				write_ack(sequence, send_time, ack);
+				socket.send_to(relay_port, ack.data);
+				statistics.bytes_sent += ack.data.size();
+				++statistics.packets_sent;
+			}
+		}
+		statistics.entries_received += count;
+		return count;
+	}
+	/// return counters
+	const replication_statistics& get_statistics() const { return statistics; }
+};
+
+/// runs a replication_client on its own thread such that socket traffic never blocks the owner, which hands over its local changes and
+/// takes the changes of other instances through queues
+class replication_channel
+{
+protected:
+	replication_client client;
+	std::thread thread;
+	std::atomic<bool> running;
+	std::mutex mutex;
+	// local changes not yet taken by the thread and remote changes not yet polled by the owner
+	std::vector<replicated_entry> outgoing, incoming;
+	// copy of the counters of the client
+	replication_statistics statistics;
+	// transforms as known to this instance, only accessed by the thread
+	std::vector<compact_transform> local;
+	// remote changes handed to the owner in poll
+	std::vector<replicated_entry> polled;
+	/// exchange changes with the relay until stopped
+	void run()
+	{
+		std::vector<replicated_entry> out, in;
+		while (running) {
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				out.swap(outgoing);
+			}
+			for (const replicated_entry& e : out) {
+				if (e.index >= local.size())
+					local.resize(e.index + 1);
+				local[e.index] = e.transform;
+				client.mark_changed(e.index);
+			}
+			out.clear();
+			client.send(local);
+			client.receive([&](uint32_t i, const compact_transform& c) {
+				// the local table follows remote changes such that they are not sent back
+				if (i >= local.size())
+					local.resize(i + 1);
+				local[i] = c;
+				replicated_entry e = { i, c };
+				in.push_back(e);
+			});
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				incoming.insert(incoming.end(), in.begin(), in.end());
+				statistics = client.get_statistics();
+			}
+			in.clear();
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+	}
+public:
+	/// construct stopped channel
+	replication_channel() : running(false) { std::memset(&statistics, 0, sizeof(statistics)); }
+	/// stop on destruction
+	~replication_channel() { stop(); }
+	/// connect to the relay on the given port and start exchanging changes, where initial holds the transforms of this instance
+	bool start(uint16_t relay_port, const std::vector<compact_transform>& initial)
+	{
+		stop();
+		if (!client.connect(relay_port))
+			return false;
+		local = initial;
+		client.mark_all_changed(uint32_t(local.size()));
+		outgoing.clear();
+		incoming.clear();
+		statistics = client.get_statistics();
+		running = true;
+		thread = std::thread(&replication_channel::run, this);
+		return true;
+	}
+	/// stop the thread and leave the relay
+	void stop()
+	{
+		running = false;
+		if (thread.joinable())
+			thread.join();
+		client.disconnect();
+	}
+	/// return whether the channel is running
+	bool is_running() const { return running; }
+	/// queue a local change to be sent by the thread
+	void submit(uint32_t index, const compact_transform& c)
+	{
+		replicated_entry e = { index, c };
+		std::lock_guard<std::mutex> lock(mutex);
+		outgoing.push_back(e);
+	}
+	/// return whether remote changes wait to be polled
+	bool has_incoming()
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		return !incoming.empty();
+	}
+	/// call on_remote(index, transform) for each remote change received since the last poll and return their number
+	template <typename remote_func>
+	size_t poll(remote_func on_remote)
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			polled.swap(incoming);
+		}
+		size_t count = polled.size();
+		for (const replicated_entry& e : polled)
+			on_remote(e.index, e.transform);
+		polled.clear();
+		return count;
+	}
+	/// return copy of the counters
+	replication_statistics get_statistics()
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		return statistics;
+	}
+};
+
+///@}
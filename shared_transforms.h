@@ -0,0 +1,206 @@
+#pragma once
+
+#include <atomic>
+#include <string>
+#include <utility>
+#include <cstdint>
+#include <cstddef>
+#ifdef _WIN32
+// keep windows.h from including winsock.h, which conflicts with winsock2.h of scene_replication.h, and from defining min and max
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+///@ingroup NI
+///@{
+
+/**@file
+   layout of box transforms published to shared memory and mapping of the segment; included by the publisher of the plugin and by external readers
+*/
+
+/// identifies the segment layout
+const uint32_t shared_transforms_magic = 0x4654494e;
+/// incremented on every change of the layout
+const uint32_t shared_transforms_version = 3;
+
+/// pose of one box
+struct shared_transform
+{
+	float translation[3];
+	// quaternion with real part first
+	float rotation[4];
+};
+
+/// entry of the ring of changed transforms
+struct shared_change
+{
+	// 2 * position + 1 while the entry is written and 2 * position + 2 once it is complete
+	std::atomic<uint64_t> sequence;
+	// snapshot in which the change was published
+	uint64_t frame;
+	uint32_t index;
+	shared_transform transform;
+};
+
+/// header at the start of the segment, followed by the table of transforms and the ring of changes
+struct shared_transforms_header
+{
+	uint32_t magic;
+	uint32_t version;
+	// maximum number of transforms in the table
+	uint32_t capacity;
+	// number of entries in the ring of changes
+	uint32_t ring_capacity;
+	// number of valid transforms in the table
+	std::atomic<uint32_t> nr_transforms;
+	// seqlock of the table, odd while the writer updates it
+	std::atomic<uint64_t> sequence;
+	// number of published snapshots
+	std::atomic<uint64_t> frame;
+	// number of changes written to the ring so far
+	std::atomic<uint64_t> ring_head;
+	// set when the publisher removes the segment, readers then follow the successor or have to open the segment again
+	std::atomic<uint32_t> closed;
+	// generation of the segment that replaces this one with a larger capacity, 0 if none; the segment of generation 0 is kept
+	// while the publisher is open and always announces the latest generation such that new readers find it
+	std::atomic<uint32_t> successor;
+};
+
+/// return the name of the segment of the given generation, which is unique such that creating it never collides with older
+/// segments that readers still map
+inline std::string get_shared_transforms_name(const std::string& name, uint32_t generation)
+{
+	return generation == 0 ? name : name + "." + std::to_string(generation);
+}
+
+/// return size of a segment with the given capacities
+inline size_t get_shared_transforms_size(uint32_t capacity, uint32_t ring_capacity)
+{
+	return sizeof(shared_transforms_header) + capacity * sizeof(shared_transform) + ring_capacity * sizeof(shared_change);
+}
+/// return table of transforms following the header
+inline shared_transform* get_shared_table(shared_transforms_header* header)
+{
+	return reinterpret_cast<shared_transform*>(header + 1);
+}
+/// return ring of changes following the table
+inline shared_change* get_shared_ring(shared_transforms_header* header)
+{
+	return reinterpret_cast<shared_change*>(get_shared_table(header) + header->capacity);
+}
+
+/// named shared memory segment mapped into the address space, using POSIX shared memory or a Windows file mapping
+class shared_memory_mapping
+{
+protected:
+	void* address;
+	size_t size;
+	std::string name;
+	bool owner;
+#ifdef _WIN32
+	HANDLE handle;
+#endif
+public:
+	/// construct unmapped
+	shared_memory_mapping() : address(0), size(0), owner(false)
+#ifdef _WIN32
+		, handle(0)
+#endif
+	{}
+	/// unmap on destruction
+	~shared_memory_mapping() { close(); }
+	/// create or open the segment of the given size and map it; a created segment is removed again on close
+	bool open(const std::string& _name, size_t _size, bool create)
+	{
+		close();
+#ifdef _WIN32
+		if (create)
+			handle = CreateFileMappingA(INVALID_HANDLE_VALUE, 0, PAGE_READWRITE, 0, (DWORD)_size, _name.c_str());
+		else
+			handle = OpenFileMappingA(FILE_MAP_READ | FILE_MAP_WRITE, FALSE, _name.c_str());
+		if (!handle)
+			return false;
+		// a mapping of the same name that readers still hold cannot be resized, so creation fails instead of reusing it
+		if (create && GetLastError() == ERROR_ALREADY_EXISTS) {
+			CloseHandle(handle);
+			handle = 0;
+			return false;
+		}
+		address = MapViewOfFile(handle, FILE_MAP_READ | FILE_MAP_WRITE, 0, 0, _size);
+		if (!address) {
+			CloseHandle(handle);
+			handle = 0;
+			return false;
+		}
+#else
+		std::string posix_name = "/" + _name;
+		int fd = shm_open(posix_name.c_str(), create ? O_CREAT | O_RDWR : O_RDWR, 0644);
+		if (fd == -1)
+			return false;
+		if (create && ftruncate(fd, (off_t)_size) == -1) {
+			::close(fd);
+			shm_unlink(posix_name.c_str());
+			return false;
+		}
+		address = mmap(0, _size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+		::close(fd);
+		if (address == MAP_FAILED) {
+			address = 0;
+			if (create)
+				shm_unlink(posix_name.c_str());
+			return false;
+		}
+#endif
+		size = _size;
+		name = _name;
+		owner = create;
+		return true;
+	}
+	/// unmap the segment and remove it if it was created by this mapping
+	void close()
+	{
+		if (!address)
+			return;
+#ifdef _WIN32
+		UnmapViewOfFile(address);
+		CloseHandle(handle);
+		handle = 0;
+#else
+		munmap(address, size);
+		if (owner)
+			shm_unlink(("/" + name).c_str());
+#endif
+		address = 0;
+		size = 0;
+		owner = false;
+	}
+	/// exchange the mapped segments of two mappings
+	void swap(shared_memory_mapping& other)
+	{
+		std::swap(address, other.address);
+		std::swap(size, other.size);
+		std::swap(name, other.name);
+		std::swap(owner, other.owner);
+#ifdef _WIN32
+		std::swap(handle, other.handle);
+#endif
+	}
+	/// return whether a segment is mapped
+	bool is_open() const { return address != 0; }
+	/// return start of the mapped segment
+	void* get_address() const { return address; }
+	/// return size of the mapped segment
+	size_t get_size() const { return size; }
+};
+
+///@}
@@ -0,0 +1,286 @@
+#pragma once
+
+#include <cgv/render/render_types.h>
+#include <unordered_map>
+#include <vector>
+#include <cstdint>
+#include <cmath>
+#include <algorithm>
+#include <limits>
+
+///@ingroup NI
+///@{
+
+/**@file
+   spatial hash of moving objects bounded by spheres
+*/
+
+/// uniform grid stored in a hash map, each object is entered into all cells overlapped by the bounding box of its bounding sphere; updates only touch cells that an object enters or leaves
+class spatial_hash : public cgv::render::render_types
+{
+protected:
+	/// range of cells overlapped by an object
+	struct cell_range
+	{
+		int lo[3], hi[3];
+		bool operator == (const cell_range& r) const
+		{
+			return std::equal(lo, lo + 3, r.lo) && std::equal(hi, hi + 3, r.hi);
+		}
+	};
+	// side length of cells
+	float cell_size;
+	// objects per non empty cell
+	std::unordered_map<uint64_t, std::vector<unsigned> > cells;
+	// cell range per object
+	std::vector<cell_range> ranges;
+	// whether object has been entered
+	std::vector<bool> entered;
+	// query stamp per object used to report each object only once
+	std::vector<unsigned> stamps;
+	unsigned stamp;
+	// range of cells overlapped by any object, which bounds ray traversals; it is only grown on updates and recomputed before the next
+	// query once an object on its boundary moved
+	cell_range bounds;
+	bool bounds_outofdate;
+	/// pack cell coordinates into a key
+	static uint64_t get_key(int i, int j, int k)
+	{
+		return (uint64_t(uint32_t(i) & 0x1fffff) << 42) | (uint64_t(uint32_t(j) & 0x1fffff) << 21) | uint64_t(uint32_t(k) & 0x1fffff);
+	}
+	/// compute range of cells overlapped by a sphere
+	cell_range get_range(const vec3& center, float radius) const
+	{
+		cell_range r;
+		for (int j = 0; j < 3; ++j) {
+			r.lo[j] = (int)std::floor((center[j] - radius) / cell_size);
+			r.hi[j] = (int)std::floor((center[j] + radius) / cell_size);
+		}
+		return r;
+	}
+	/// recompute bounds from the cell ranges of all objects if an object on the boundary moved
+	void update_bounds()
+	{
+		if (!bounds_outofdate)
+			return;
+		std::fill(bounds.lo, bounds.lo + 3, std::numeric_limits<int>::max());
+		std::fill(bounds.hi, bounds.hi + 3, std::numeric_limits<int>::min());
+		for (size_t oi = 0; oi < ranges.size(); ++oi) {
+			if (!entered[oi])
+				continue;
+			for (int j = 0; j < 3; ++j) {
+				bounds.lo[j] = std::min(bounds.lo[j], ranges[oi].lo[j]);
+				bounds.hi[j] = std::max(bounds.hi[j], ranges[oi].hi[j]);
+			}
+		}
+		bounds_outofdate = false;
+	}
+	/// start a new query such that each object is reported once
+	void next_stamp()
+	{
+		if (++stamp == 0) {
+			std::fill(stamps.begin(), stamps.end(), 0);
+			stamp = 1;
+		}
+	}
+	/// call on_candidate for all objects in cell i,j,k not reported before in the current query
+	template <typename candidate_func>
+	void visit_cell(int i, int j, int k, candidate_func& on_candidate)
+	{
+		auto iter = cells.find(get_key(i, j, k));
+		if (iter == cells.end())
+			return;
+		for (unsigned oi : iter->second)
+			if (stamps[oi] != stamp) {
+				stamps[oi] = stamp;
+				on_candidate(oi);
+			}
+	}
+	/// add or remove object to or from all cells of a range
+	void apply(unsigned oi, const cell_range& r, bool insert)
+	{
+		for (int k = r.lo[2]; k <= r.hi[2]; ++k)
+			for (int j = r.lo[1]; j <= r.hi[1]; ++j)
+				for (int i = r.lo[0]; i <= r.hi[0]; ++i) {
+					uint64_t key = get_key(i, j, k);
+					if (insert) {
+						cells[key].push_back(oi);
+						continue;
+					}
+					auto iter = cells.find(key);
+					if (iter == cells.end())
+						continue;
+					std::vector<unsigned>& C = iter->second;
+					auto pos = std::find(C.begin(), C.end(), oi);
+					if (pos != C.end()) {
+						*pos = C.back();
+						C.pop_back();
+					}
+					if (C.empty())
+						cells.erase(iter);
+				}
+	}
+public:
+	/// construct empty hash
+	spatial_hash(float _cell_size = 0.25f) { clear(_cell_size); }
+	/// remove all objects and set the cell size
+	void clear(float _cell_size)
+	{
+		cell_size = _cell_size;
+		cells.clear();
+		ranges.clear();
+		entered.clear();
+		stamps.clear();
+		stamp = 0;
+		std::fill(bounds.lo, bounds.lo + 3, std::numeric_limits<int>::max());
+		std::fill(bounds.hi, bounds.hi + 3, std::numeric_limits<int>::min());
+		bounds_outofdate = false;
+	}
+	/// enter object oi with the given bounding sphere or move it there if it was entered before
+	void update(unsigned oi, const vec3& center, float radius)
+	{
+		if (oi >= ranges.size()) {
+			ranges.resize(oi + 1);
+			entered.resize(oi + 1, false);
+			stamps.resize(oi + 1, 0);
+		}
+		cell_range r = get_range(center, radius);
+		if (entered[oi]) {
+			if (r == ranges[oi])
+				return;
+			apply(oi, ranges[oi], false);
+			for (int j = 0; j < 3; ++j)
+				if (ranges[oi].lo[j] == bounds.lo[j] || ranges[oi].hi[j] == bounds.hi[j])
+					bounds_outofdate = true;
+		}
+		apply(oi, r, true);
+		ranges[oi] = r;
+		entered[oi] = true;
+		for (int j = 0; j < 3; ++j) {
+			bounds.lo[j] = std::min(bounds.lo[j], r.lo[j]);
+			bounds.hi[j] = std::max(bounds.hi[j], r.hi[j]);
+		}
+	}
+	/// call on_candidate once for every object whose cells overlap the bounding box of the query sphere
+	template <typename candidate_func>
+	void query(const vec3& center, float radius, candidate_func on_candidate)
+	{
+		next_stamp();
+		cell_range r = get_range(center, radius);
+		for (int k = r.lo[2]; k <= r.hi[2]; ++k)
+			for (int j = r.lo[1]; j <= r.hi[1]; ++j)
+				for (int i = r.lo[0]; i <= r.hi[0]; ++i)
+					visit_cell(i, j, k, on_candidate);
+	}
+	/// visit the cells pierced by the ray in front to back order and call on_candidate once for every object in them; traversal stops
+	/// once the next cell starts behind t_max, which on_candidate may lower to the closest hit found so far
+	template <typename candidate_func>
+	void query_ray(const vec3& origin, const vec3& direction, float& t_max, candidate_func on_candidate)
+	{
+		update_bounds();
+		if (bounds.lo[0] > bounds.hi[0])
+			return;
+		next_stamp();
+		// clip ray against the cells that contain any object
+		float t_enter = 0, t_exit = t_max;
+		for (int j = 0; j < 3; ++j) {
+			float lo = bounds.lo[j] * cell_size, hi = (bounds.hi[j] + 1) * cell_size;
+			if (direction[j] == 0) {
+				if (origin[j] < lo || origin[j] > hi)
+					return;
+				continue;
+			}
+			float t0 = (lo - origin[j]) / direction[j], t1 = (hi - origin[j]) / direction[j];
+			if (t0 > t1)
+				std::swap(t0, t1);
+			t_enter = std::max(t_enter, t0);
+			t_exit = std::min(t_exit, t1);
+		}
+		if (t_enter > t_exit)
+			return;
+		// 3d digital differential analyzer starting in the cell where the ray enters the bounds
+		int cell[3], step[3];
+		float t_next[3], t_delta[3];
+		for (int j = 0; j < 3; ++j) {
+			float x = origin[j] + t_enter * direction[j];
+			cell[j] = std::max(bounds.lo[j], std::min(bounds.hi[j], (int)std::floor(x / cell_size)));
+			if (direction[j] == 0) {
+				step[j] = 0;
+				t_next[j] = t_delta[j] = std::numeric_limits<float>::infinity();
+				continue;
+			}
+			step[j] = direction[j] > 0 ? 1 : -1;
+			t_next[j] = ((cell[j] + (step[j] > 0 ? 1 : 0)) * cell_size - origin[j]) / direction[j];
+			t_delta[j] = cell_size / std::abs(direction[j]);
+		}
+		for (;;) {
+			visit_cell(cell[0], cell[1], cell[2], on_candidate);
+			int j = t_next[0] < t_next[1] ? (t_next[0] < t_next[2] ? 0 : 2) : (t_next[1] < t_next[2] ? 1 : 2);
+			if (t_next[j] > std::min(t_max, t_exit))
+				return;
+			cell[j] += step[j];
+			if (cell[j] < bounds.lo[j] || cell[j] > bounds.hi[j])
+				return;
+			t_next[j] += t_delta[j];
+		}
+	}
+	/// call on_candidate once for every object in the cells overlapped by the cone with apex origin, unit axis and half opening angle;
+	/// the axis is walked in steps of one cell and at each step the cells around the cone section are visited, whose radius grows with
+	/// the distance from the apex; objects reaching into the cone only behind axis parameter t are reported at a step starting before
+	/// t, so the walk stops once the next step starts behind t_max, which on_candidate may lower
+	template <typename candidate_func>
+	void query_cone(const vec3& origin, const vec3& axis, float half_angle, float& t_max, candidate_func on_candidate)
+	{
+		update_bounds();
+		if (bounds.lo[0] > bounds.hi[0])
+			return;
+		next_stamp();
+		// no point of the bounds is farther from the apex than its farthest corner, where the cone reaches its largest radius
+		float sqr_far = 0;
+		for (int j = 0; j < 3; ++j) {
+			float lo = bounds.lo[j] * cell_size, hi = (bounds.hi[j] + 1) * cell_size;
+			float f = std::max(std::abs(lo - origin[j]), std::abs(hi - origin[j]));
+			sqr_far += f * f;
+		}
+		float tan_half_angle = std::tan(std::min(half_angle, 1.5f));
+		float t_end = std::sqrt(sqr_far), r_end = t_end * tan_half_angle;
+		// clip the axis against the bounds grown by the largest radius
+		float t = 0;
+		for (int j = 0; j < 3; ++j) {
+			float lo = bounds.lo[j] * cell_size - r_end, hi = (bounds.hi[j] + 1) * cell_size + r_end;
+			if (axis[j] == 0) {
+				if (origin[j] < lo || origin[j] > hi)
+					return;
+				continue;
+			}
+			float t0 = (lo - origin[j]) / axis[j], t1 = (hi - origin[j]) / axis[j];
+			if (t0 > t1)
+				std::swap(t0, t1);
+			t = std::max(t, t0);
+			t_end = std::min(t_end, t1);
+		}
+		// cells of the previous step are skipped as consecutive sections overlap
+		cell_range prev = { { 1, 1, 1 }, { 0, 0, 0 } };
+		for (; t < std::min(t_end, t_max); t += cell_size) {
+			// ball containing the cone section between t and t + cell_size
+			float radius = 0.5f * cell_size + (t + cell_size) * tan_half_angle;
+			cell_range r = get_range(origin + (t + 0.5f * cell_size) * axis, radius);
+			for (int j = 0; j < 3; ++j) {
+				r.lo[j] = std::max(r.lo[j], bounds.lo[j]);
+				r.hi[j] = std::min(r.hi[j], bounds.hi[j]);
+			}
+			for (int k = r.lo[2]; k <= r.hi[2]; ++k)
+				for (int j = r.lo[1]; j <= r.hi[1]; ++j)
+					for (int i = r.lo[0]; i <= r.hi[0]; ++i)
+						if (i < prev.lo[0] || i > prev.hi[0] || j < prev.lo[1] || j > prev.hi[1] || k < prev.lo[2] || k > prev.hi[2])
+							visit_cell(i, j, k, on_candidate);
+			prev = r;
+		}
+	}
+	/// return number of non empty cells
+	size_t get_nr_cells() const { return cells.size(); }
+	/// return side length of cells
+	float get_cell_size() const { return cell_size; }
+};
+
+///@}
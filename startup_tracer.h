@@ -0,0 +1,97 @@
+#pragma once
+
+#include <chrono>
+#include <string>
+#include <vector>
+#include <mutex>
+#include <ostream>
+#include <iomanip>
+
+///@ingroup NI
+///@{
+
+/**@file
+   tracing of the phases on the critical path from plugin load to the first frame
+*/
+
+/// records named phases with start time and duration relative to the construction of the tracer and the time at which the first frame was finished; phases may be added from background threads
+class startup_tracer
+{
+public:
+	/// a traced phase, times in milliseconds since construction
+	struct phase
+	{
+		std::string name;
+		double start_ms;
+		double duration_ms;
+	};
+	/// traces the lifetime of the scope as a phase
+	class scope
+	{
+		startup_tracer& tracer;
+		std::string name;
+		double start_ms;
+	public:
+		scope(startup_tracer& _tracer, const std::string& _name) : tracer(_tracer), name(_name), start_ms(_tracer.get_elapsed_ms()) {}
+		~scope() { tracer.add(name, start_ms); }
+	};
+protected:
+	std::chrono::steady_clock::time_point origin;
+	mutable std::mutex mutex;
+	std::vector<phase> phases;
+	// time at which the first frame was finished or negative before
+	double first_frame_ms;
+public:
+	/// start the clock
+	startup_tracer() : origin(std::chrono::steady_clock::now()), first_frame_ms(-1) {}
+	/// return milliseconds since construction
+	double get_elapsed_ms() const
+	{
+		return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - origin).count();
+	}
+	/// add phase that started at start_ms and ends now
+	void add(const std::string& name, double start_ms)
+	{
+		phase p = { name, start_ms, get_elapsed_ms() - start_ms };
+		std::lock_guard<std::mutex> lock(mutex);
+		phases.push_back(p);
+	}
+	/// record the end of the first frame, returns false if it had been recorded before
+	bool mark_first_frame()
+	{
+		if (first_frame_ms >= 0)
+			return false;
+		first_frame_ms = get_elapsed_ms();
+		return true;
+	}
+	/// return time to the first frame in milliseconds or a negative value if no frame has been finished yet
+	double get_first_frame_ms() const { return first_frame_ms; }
+	/// return copy of the traced phases in the order of their completion
+	std::vector<phase> get_phases() const
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		return phases;
+	}
+	/// write one line per phase and the time to the first frame
+	void report(std::ostream& os) const
+	{
+		std::ios::fmtflags flags = os.flags();
+		std::streamsize precision = os.precision();
+		os << "startup trace:\n" << std::fixed << std::setprecision(1);
+		for (const phase& p : get_phases())
+			os << "  " << std::setw(8) << p.start_ms << " ms +" << std::setw(8) << p.duration_ms << " ms  " << p.name << "\n";
+		if (first_frame_ms >= 0)
+			os << "  time to first frame " << first_frame_ms << " ms" << std::endl;
+		os.flags(flags);
+		os.precision(precision);
+	}
+};
+
+/// return the tracer of the process, which is constructed at the first call
+inline startup_tracer& ref_startup_tracer()
+{
+	static startup_tracer tracer;
+	return tracer;
+}
+
+///@}
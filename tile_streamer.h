@@ -0,0 +1,232 @@
+#pragma once
+
+#include <map>
+#include <deque>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <algorithm>
+#include <cmath>
+
+///@ingroup NI
+///@{
+
+/**@file
+   streaming of square tiles on the xz-plane around a moving viewer
+*/
+
+/// tiles are loaded on background threads, made resident within a per frame budget and evicted once they are far from the viewer; tile_type needs to provide int members i and j
+template <typename tile_type>
+class tile_streamer
+{
+public:
+	/// tile coordinates
+	typedef std::pair<int, int> tile_key;
+	/// map from tile coordinates to resident tiles
+	typedef std::map<tile_key, std::unique_ptr<tile_type> > tile_map;
+	/// counters reported to the user
+	struct statistics
+	{
+		unsigned resident;
+		unsigned in_flight;
+		unsigned evicted;
+		unsigned uploaded;
+	};
+protected:
+	// side length of a tile
+	float tile_size;
+	// half side length of the square region in which tiles exist
+	float world_radius;
+	// function called on worker threads to fill a tile
+	std::function<void(tile_type&)> load;
+	// worker threads
+	std::vector<std::thread> workers;
+	// protects jobs, finished and stopping
+	std::mutex mutex;
+	std::condition_variable job_available;
+	// tiles waiting to be loaded, ordered by priority
+	std::deque<tile_key> jobs;
+	// loaded tiles waiting to be made resident
+	std::deque<std::unique_ptr<tile_type> > finished;
+	bool stopping;
+	// tiles requested but not yet resident
+	std::map<tile_key, bool> requested;
+	// tiles whose data is available to the renderer
+	tile_map resident;
+	// last viewer position
+	float viewer_x, viewer_z;
+	// radius beyond which tiles are evicted
+	float evict_radius;
+	// accumulated counters
+	unsigned nr_evicted, nr_uploaded;
+	/// distance on the xz-plane from the viewer to the closest point of a tile
+	float distance(const tile_key& k) const
+	{
+		float dx = std::max(std::max(k.first * tile_size - viewer_x, viewer_x - (k.first + 1) * tile_size), 0.0f);
+		float dz = std::max(std::max(k.second * tile_size - viewer_z, viewer_z - (k.second + 1) * tile_size), 0.0f);
+		return std::sqrt(dx * dx + dz * dz);
+	}
+	/// main loop of worker threads
+	void work()
+	{
+		for (;;) {
+			tile_key k;
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				job_available.wait(lock, [this] { return stopping || !jobs.empty(); });
+				if (stopping)
+					return;
+				k = jobs.front();
+				jobs.pop_front();
+			}
+			std::unique_ptr<tile_type> tile(new tile_type());
+			tile->i = k.first;
+			tile->j = k.second;
+			load(*tile);
+			std::lock_guard<std::mutex> lock(mutex);
+			finished.push_back(std::move(tile));
+		}
+	}
+public:
+	/// construct stopped streamer
+	tile_streamer() : tile_size(16.0f), world_radius(1000.0f), stopping(false),
+		viewer_x(0), viewer_z(0), evict_radius(0), nr_evicted(0), nr_uploaded(0) {}
+	/// stop worker threads on destruction
+	~tile_streamer() { stop(); }
+	/// return whether worker threads are running
+	bool is_running() const { return !workers.empty(); }
+	/// return side length of tiles
+	float get_tile_size() const { return tile_size; }
+	/// start worker threads that call the load function for each requested tile
+	void start(unsigned nr_threads, float _tile_size, float _world_radius, std::function<void(tile_type&)> _load)
+	{
+		stop();
+		tile_size = _tile_size;
+		world_radius = _world_radius;
+		load = _load;
+		stopping = false;
+		for (unsigned t = 0; t < std::max(nr_threads, 1u); ++t)
+			workers.push_back(std::thread(&tile_streamer::work, this));
+	}
+	/// stop worker threads and drop pending and finished tiles, resident tiles stay untouched
+	void stop()
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			stopping = true;
+			jobs.clear();
+		}
+		job_available.notify_all();
+		for (auto& w : workers)
+			w.join();
+		workers.clear();
+		finished.clear();
+		requested.clear();
+	}
+	/// request tiles within load_radius of the viewer and evict resident tiles beyond _evict_radius, on_evict is called for each tile before it is deleted
+	template <typename evict_func>
+	void update(float x, float z, float load_radius, float _evict_radius, evict_func on_evict)
+	{
+		viewer_x = x;
+		viewer_z = z;
+		evict_radius = std::max(_evict_radius, load_radius);
+		// evict far tiles
+		for (auto iter = resident.begin(); iter != resident.end(); ) {
+			if (distance(iter->first) > evict_radius) {
+				on_evict(*iter->second);
+				iter = resident.erase(iter);
+				++nr_evicted;
+			}
+			else
+				++iter;
+		}
+		// collect missing tiles in range
+		std::vector<std::pair<float, tile_key> > missing;
+		int i0 = (int)std::floor(std::max(x - load_radius, -world_radius) / tile_size);
+		int i1 = (int)std::floor((std::min(x + load_radius, world_radius) - 0.0001f) / tile_size);
+		int j0 = (int)std::floor(std::max(z - load_radius, -world_radius) / tile_size);
+		int j1 = (int)std::floor((std::min(z + load_radius, world_radius) - 0.0001f) / tile_size);
+		for (int j = j0; j <= j1; ++j)
+			for (int i = i0; i <= i1; ++i) {
+				tile_key k(i, j);
+				float d = distance(k);
+				if (d <= load_radius && resident.find(k) == resident.end() && requested.find(k) == requested.end())
+					missing.push_back(std::make_pair(d, k));
+			}
+		std::sort(missing.begin(), missing.end());
+		std::lock_guard<std::mutex> lock(mutex);
+		// cancel jobs that are no longer needed
+		for (auto iter = jobs.begin(); iter != jobs.end(); ) {
+			if (distance(*iter) > evict_radius) {
+				requested.erase(*iter);
+				iter = jobs.erase(iter);
+			}
+			else
+				++iter;
+		}
+		for (const auto& m : missing) {
+			jobs.push_back(m.second);
+			requested[m.second] = true;
+		}
+		if (!missing.empty())
+			job_available.notify_all();
+	}
+	/// make at most budget loaded tiles resident, on_upload is called for each of them; returns number of uploaded tiles
+	template <typename upload_func>
+	unsigned upload(unsigned budget, upload_func on_upload)
+	{
+		unsigned count = 0;
+		while (count < budget) {
+			std::unique_ptr<tile_type> tile;
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				if (finished.empty())
+					break;
+				tile = std::move(finished.front());
+				finished.pop_front();
+			}
+			tile_key k(tile->i, tile->j);
+			requested.erase(k);
+			// drop tiles that went out of range while they were loaded
+			if (distance(k) > evict_radius)
+				continue;
+			on_upload(*tile);
+			resident[k] = std::move(tile);
+			++count;
+		}
+		nr_uploaded += count;
+		return count;
+	}
+	/// evict all resident tiles
+	template <typename evict_func>
+	void clear(evict_func on_evict)
+	{
+		for (auto& r : resident)
+			on_evict(*r.second);
+		nr_evicted += (unsigned)resident.size();
+		resident.clear();
+	}
+	/// access resident tiles
+	const tile_map& get_resident_tiles() const { return resident; }
+	/// return resident tile containing xz-position or 0 if not resident
+	const tile_type* find_tile(float x, float z) const
+	{
+		auto iter = resident.find(tile_key((int)std::floor(x / tile_size), (int)std::floor(z / tile_size)));
+		return iter == resident.end() ? 0 : iter->second.get();
+	}
+	/// return current counters
+	statistics get_statistics() const
+	{
+		statistics s;
+		s.resident = (unsigned)resident.size();
+		s.in_flight = (unsigned)requested.size();
+		s.evicted = nr_evicted;
+		s.uploaded = nr_uploaded;
+		return s;
+	}
+};
+
+///@}
@@ -0,0 +1,222 @@
+#pragma once
+
+#include "shared_transforms.h"
+#include <cgv/render/render_types.h>
+#include <vector>
+#include <new>
+#include <algorithm>
+
+///@ingroup NI
+///@{
+
+/**@file
+   publication of box transforms to shared memory
+*/
+
+/// writes box transforms into a shared memory segment; only transforms that changed since the last publication are written to the table, under a seqlock, and appended to the ring of changes, such that the writer never waits for readers
+class transform_publisher : public cgv::render::render_types
+{
+protected:
+	// segment of the current generation
+	shared_memory_mapping mapping;
+	shared_transforms_header* header;
+	// segment of generation 0 kept while a later generation is current, such that new readers find the latest generation
+	shared_memory_mapping first_mapping;
+	shared_transforms_header* first_header;
+	// name given to open and generation of the current segment
+	std::string name;
+	uint32_t generation;
+	// copy of the last published transforms used to detect changes
+	std::vector<shared_transform> published;
+	// indices of transforms changed in the current publication
+	std::vector<uint32_t> changed;
+	// number of transforms written in the last publication
+	size_t nr_changed;
+	/// convert pose to shared layout
+	static shared_transform to_shared(const vec3& t, const quat& q)
+	{
+		shared_transform s = { { t[0], t[1], t[2] }, { q.re(), q.im()[0], q.im()[1], q.im()[2] } };
+		return s;
+	}
+	/// compare transforms bitwise
+	static bool equal(const shared_transform& a, const shared_transform& b)
+	{
+		for (int j = 0; j < 3; ++j)
+			if (a.translation[j] != b.translation[j])
+				return false;
+		for (int j = 0; j < 4; ++j)
+			if (a.rotation[j] != b.rotation[j])
+				return false;
+		return true;
+	}
+	/// write the transforms listed in changed to the table and the ring and set the number of transforms to count
+	void write_changes(uint32_t count)
+	{
+		uint64_t frame = header->frame.load(std::memory_order_relaxed) + 1;
+		// update table under the seqlock
+		shared_transform* table = get_shared_table(header);
+		uint64_t sequence = header->sequence.load(std::memory_order_relaxed);
+		header->sequence.store(sequence + 1, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+		for (uint32_t i : changed)
+			table[i] = published[i];
+		header->nr_transforms.store(count, std::memory_order_relaxed);
+		header->frame.store(frame, std::memory_order_relaxed);
+		header->sequence.store(sequence + 2, std::memory_order_release);
+		// append changes to the ring, each entry carries its own sequence number
+		shared_change* ring = get_shared_ring(header);
+		uint64_t head = header->ring_head.load(std::memory_order_relaxed);
+		for (uint32_t i : changed) {
+			shared_change& c = ring[head % header->ring_capacity];
+			c.sequence.store(2 * head + 1, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_release);
+			c.frame = frame;
+			c.index = i;
+			c.transform = published[i];
+			c.sequence.store(2 * head + 2, std::memory_order_release);
+			++head;
+		}
+		header->ring_head.store(head, std::memory_order_release);
+	}
+	/// create and initialize a segment in the given mapping, the magic number is written last such that readers never see a partial header
+	static shared_transforms_header* create_segment(shared_memory_mapping& m, const std::string& segment_name, uint32_t capacity, uint32_t ring_capacity)
+	{
+		if (!m.open(segment_name, get_shared_transforms_size(capacity, ring_capacity), true))
+			return 0;
+		shared_transforms_header* h = new (m.get_address()) shared_transforms_header();
+		h->capacity = capacity;
+		h->ring_capacity = ring_capacity;
+		h->nr_transforms.store(0);
+		h->sequence.store(0);
+		h->frame.store(0);
+		h->ring_head.store(0);
+		h->closed.store(0);
+		h->successor.store(0);
+		shared_change* ring = get_shared_ring(h);
+		for (uint32_t i = 0; i < ring_capacity; ++i)
+			new (ring + i) shared_change();
+		for (uint32_t i = 0; i < ring_capacity; ++i)
+			ring[i].sequence.store(0);
+		h->version = shared_transforms_version;
+		std::atomic_thread_fence(std::memory_order_release);
+		h->magic = shared_transforms_magic;
+		return h;
+	}
+public:
+	/// construct closed publisher
+	transform_publisher() : header(0), first_header(0), generation(0), nr_changed(0) {}
+	/// create segment of the given name for up to capacity transforms and a ring of ring_capacity changes
+	bool open(const std::string& _name, uint32_t capacity, uint32_t ring_capacity)
+	{
+		close();
+		header = create_segment(mapping, _name, capacity, ring_capacity);
+		if (!header)
+			return false;
+		name = _name;
+		generation = 0;
+		return true;
+	}
+	/// replace the segment by one of the next generation with the given capacity that holds the published transforms; the new
+	/// segment gets a name of its own, so it can be created while readers still map the old one, and is announced in the old header
+	/// and in the header of generation 0
+	bool grow(uint32_t capacity)
+	{
+		if (!header)
+			return false;
+		shared_memory_mapping next_mapping;
+		shared_transforms_header* next = create_segment(next_mapping, get_shared_transforms_name(name, generation + 1), capacity, header->ring_capacity);
+		if (!next)
+			return false;
+		// copy the published table such that readers following the successor find the last snapshot
+		uint32_t count = (uint32_t)std::min(published.size(), (size_t)capacity);
+		std::copy(published.begin(), published.begin() + count, get_shared_table(next));
+		published.resize(count);
+		next->nr_transforms.store(count, std::memory_order_relaxed);
+		next->frame.store(header->frame.load(std::memory_order_relaxed), std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+		++generation;
+		header->successor.store(generation, std::memory_order_release);
+		header->closed.store(1, std::memory_order_release);
+		if (first_header)
+			first_header->successor.store(generation, std::memory_order_release);
+		else {
+			// generation 0 stays mapped as entry point for readers that open the segment later
+			first_mapping.swap(mapping);
+			first_header = header;
+		}
+		mapping.swap(next_mapping);
+		header = next;
+		return true;
+	}
+	/// remove segments after marking them closed for readers that still map them
+	void close()
+	{
+		if (header)
+			header->closed.store(1, std::memory_order_release);
+		if (first_header)
+			first_header->closed.store(1, std::memory_order_release);
+		mapping.close();
+		first_mapping.close();
+		header = 0;
+		first_header = 0;
+		generation = 0;
+		published.clear();
+	}
+	/// return whether the segment exists
+	bool is_open() const { return header != 0; }
+	/// return maximum number of transforms of the open segment
+	uint32_t get_capacity() const { return header ? header->capacity : 0; }
+	/// return generation of the current segment, which is incremented by grow
+	uint32_t get_generation() const { return generation; }
+	/// publish n transforms, of which only the changed ones are written; transforms beyond the capacity are dropped, so callers
+	/// grow the segment first; returns number of written transforms
+	size_t publish(const vec3* translations, const quat* rotations, size_t n)
+	{
+		if (!header)
+			return 0;
+		uint32_t count = (uint32_t)std::min(n, (size_t)header->capacity);
+		changed.clear();
+		published.resize(count);
+		for (uint32_t i = 0; i < count; ++i) {
+			shared_transform s = to_shared(translations[i], rotations[i]);
+			if (i < header->nr_transforms.load(std::memory_order_relaxed) && equal(s, published[i]))
+				continue;
+			published[i] = s;
+			changed.push_back(i);
+		}
+		nr_changed = changed.size();
+		if (changed.empty() && count == header->nr_transforms.load(std::memory_order_relaxed))
+			return 0;
+		write_changes(count);
+		return nr_changed;
+	}
+	/// publish n transforms of which only those listed in indices may have changed since the last publication, which avoids comparing
+	/// all of them; falls back to publish if the number of transforms changed
+	size_t publish_changes(const vec3* translations, const quat* rotations, size_t n, const std::vector<unsigned>& indices)
+	{
+		if (!header)
+			return 0;
+		if (n != published.size() || n != header->nr_transforms.load(std::memory_order_relaxed))
+			return publish(translations, rotations, n);
+		changed.clear();
+		for (unsigned i : indices) {
+			if (i >= n)
+				continue;
+			shared_transform s = to_shared(translations[i], rotations[i]);
+			if (equal(s, published[i]))
+				continue;
+			published[i] = s;
+			changed.push_back(i);
+		}
+		nr_changed = changed.size();
+		if (!changed.empty())
+			write_changes((uint32_t)n);
+		return nr_changed;
+	}
+	/// return number of transforms written in the last publication
+	size_t get_nr_changed() const { return nr_changed; }
+	/// return number of published snapshots
+	uint64_t get_frame() const { return header ? header->frame.load(std::memory_order_relaxed) : 0; }
+};
+
+///@}
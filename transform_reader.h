@@ -0,0 +1,143 @@
+#pragma once
+
+#include "shared_transforms.h"
+#include <vector>
+#include <cstring>
+
+///@ingroup NI
+///@{
+
+/**@file
+   header only reader of box transforms published by natural_interfaces, it depends only on the standard library and the operating system
+*/
+
+/// reads snapshots of the transform table or the changes since the last read without ever blocking the publisher
+class transform_reader
+{
+protected:
+	shared_memory_mapping mapping;
+	shared_transforms_header* header;
+	// name given to open, under which generation 0 of the segment is published
+	std::string name;
+	// ring position up to which changes have been read
+	uint64_t ring_tail;
+	/// map the segment of the given name, fails if it does not exist or has an incompatible layout
+	bool open_segment(const std::string& segment_name)
+	{
+		mapping.close();
+		header = 0;
+		// map the header first to learn the size of the segment
+		if (!mapping.open(segment_name, sizeof(shared_transforms_header), false))
+			return false;
+		shared_transforms_header* h = static_cast<shared_transforms_header*>(mapping.get_address());
+		if (h->magic != shared_transforms_magic || h->version != shared_transforms_version) {
+			mapping.close();
+			return false;
+		}
+		std::atomic_thread_fence(std::memory_order_acquire);
+		size_t size = get_shared_transforms_size(h->capacity, h->ring_capacity);
+		if (!mapping.open(segment_name, size, false))
+			return false;
+		header = static_cast<shared_transforms_header*>(mapping.get_address());
+		ring_tail = header->ring_head.load(std::memory_order_acquire);
+		return true;
+	}
+public:
+	/// construct closed reader
+	transform_reader() : header(0), ring_tail(0) {}
+	/// open the latest segment published under the given name, fails if it does not exist or has an incompatible layout
+	bool open(const std::string& _name)
+	{
+		close();
+		name = _name;
+		if (!open_segment(name))
+			return false;
+		// generation 0 announces the latest generation, which may itself have been replaced in the meantime
+		for (unsigned attempt = 0; attempt < 16; ++attempt) {
+			uint32_t generation = header->successor.load(std::memory_order_acquire);
+			if (generation == 0)
+				return !is_stale();
+			if (!open_segment(get_shared_transforms_name(name, generation)) && !open_segment(name))
+				return false;
+		}
+		return false;
+	}
+	/// follow a stale segment to the segment that replaced it, falling back to opening the latest generation; returns false if the
+	/// publisher removed the segment without replacement; read a snapshot after following as the changes start anew
+	bool follow()
+	{
+		if (!header)
+			return false;
+		if (!is_stale())
+			return true;
+		uint32_t generation = header->successor.load(std::memory_order_acquire);
+		if (generation != 0 && open_segment(get_shared_transforms_name(name, generation)) && !is_stale())
+			return true;
+		std::string base_name = name;
+		return open(base_name);
+	}
+	/// close the segment
+	void close()
+	{
+		mapping.close();
+		header = 0;
+	}
+	/// return whether a segment is open
+	bool is_open() const { return header != 0; }
+	/// return whether the publisher removed the open segment, e.g. to grow it, such that follow has to be called
+	bool is_stale() const { return header && header->closed.load(std::memory_order_acquire) != 0; }
+	/// copy the complete table, retrying while the publisher writes it; frame receives the number of the snapshot; fails on stale segments
+	bool read_snapshot(std::vector<shared_transform>& transforms, uint64_t& frame, unsigned max_attempts = 1000)
+	{
+		if (!header || is_stale())
+			return false;
+		const shared_transform* table = get_shared_table(header);
+		for (unsigned attempt = 0; attempt < max_attempts; ++attempt) {
+			uint64_t sequence = header->sequence.load(std::memory_order_acquire);
+			if (sequence & 1)
+				continue;
+			uint64_t head = header->ring_head.load(std::memory_order_acquire);
+			uint32_t n = header->nr_transforms.load(std::memory_order_relaxed);
+			frame = header->frame.load(std::memory_order_relaxed);
+			transforms.resize(n);
+			if (n > 0)
+				std::memcpy(&transforms[0], table, n * sizeof(shared_transform));
+			std::atomic_thread_fence(std::memory_order_acquire);
+			if (header->sequence.load(std::memory_order_relaxed) == sequence) {
+				// changes older than the snapshot need not be read anymore
+				ring_tail = head;
+				return true;
+			}
+		}
+		return false;
+	}
+	/// call on_change(index, transform, frame) for each change published since the last read; returns false if the publisher overwrote unread changes, in which case a snapshot needs to be read, or if the segment is stale
+	template <typename change_func>
+	bool read_changes(change_func on_change)
+	{
+		if (!header || is_stale())
+			return false;
+		shared_change* ring = get_shared_ring(header);
+		uint64_t head = header->ring_head.load(std::memory_order_acquire);
+		if (head - ring_tail > header->ring_capacity)
+			return false;
+		for (; ring_tail < head; ++ring_tail) {
+			shared_change& c = ring[ring_tail % header->ring_capacity];
+			uint64_t sequence = c.sequence.load(std::memory_order_acquire);
+			if (sequence != 2 * ring_tail + 2)
+				return false;
+			uint64_t frame = c.frame;
+			uint32_t index = c.index;
+			shared_transform transform = c.transform;
+			std::atomic_thread_fence(std::memory_order_acquire);
+			if (c.sequence.load(std::memory_order_relaxed) != sequence)
+				return false;
+			on_change(index, transform, frame);
+		}
+		return true;
+	}
+	/// return number of the latest published snapshot
+	uint64_t get_frame() const { return header ? header->frame.load(std::memory_order_acquire) : 0; }
+};
+
+///@}
@@ -0,0 +1,119 @@
+#include "transform_publisher.h"
+#include "transform_reader.h"
+#include <chrono>
+#include <iostream>
+#include <string>
+
+///@ingroup NI
+///@{
+
+/**@file
+   standalone round trip of box transforms from transform_publisher to transform_reader including growth of the segment,
+   returns non zero on failure
+*/
+
+typedef cgv::render::render_types::vec3 vec3;
+typedef cgv::render::render_types::quat quat;
+
+/// count failed checks and report them
+struct checker
+{
+	unsigned nr_failures;
+	checker() : nr_failures(0) {}
+	void check(bool passed, const std::string& what)
+	{
+		if (!passed) {
+			std::cout << "failed: " << what << std::endl;
+			++nr_failures;
+		}
+	}
+};
+
+/// deterministic pose of box i in publication round r
+void make_pose(unsigned i, unsigned r, vec3& t, quat& q)
+{
+	t = vec3(float(i), float(r), 0.5f * i);
+	q = quat(1.0f, 0.0f, 0.0f, 0.0f);
+}
+
+/// check that the reader sees the snapshot of n boxes published in round r
+bool snapshot_matches(transform_reader& reader, unsigned n, unsigned r)
+{
+	std::vector<shared_transform> transforms;
+	uint64_t frame;
+	if (!reader.read_snapshot(transforms, frame) || transforms.size() != n)
+		return false;
+	for (unsigned i = 0; i < n; ++i) {
+		vec3 t;
+		quat q;
+		make_pose(i, r, t, q);
+		for (int j = 0; j < 3; ++j)
+			if (transforms[i].translation[j] != t[j])
+				return false;
+	}
+	return true;
+}
+
+/// publish poses of n boxes for round r and grow the segment like the plugin does
+void publish_round(transform_publisher& publisher, unsigned n, unsigned r)
+{
+	std::vector<vec3> translations(n);
+	std::vector<quat> rotations(n);
+	for (unsigned i = 0; i < n; ++i)
+		make_pose(i, r, translations[i], rotations[i]);
+	if (n > publisher.get_capacity())
+		publisher.grow(2 * n);
+	publisher.publish(translations.data(), rotations.data(), n);
+}
+
+int main(int, char**)
+{
+	checker C;
+	// a name of its own keeps parallel runs and left over segments of crashed runs apart
+	std::string name = "ni_transform_test_" + std::to_string(std::chrono::steady_clock::now().time_since_epoch().count());
+	transform_publisher publisher;
+	C.check(publisher.open(name, 4, 16), "publisher opens segment");
+	publish_round(publisher, 3, 0);
+
+	transform_reader reader;
+	C.check(reader.open(name), "reader opens segment");
+	C.check(snapshot_matches(reader, 3, 0), "snapshot after first publication");
+
+	// a single changed box is written once to the ring
+	std::vector<vec3> translations(3);
+	std::vector<quat> rotations(3);
+	for (unsigned i = 0; i < 3; ++i)
+		make_pose(i, 0, translations[i], rotations[i]);
+	translations[1] = vec3(7.0f, 8.0f, 9.0f);
+	C.check(publisher.publish(translations.data(), rotations.data(), 3) == 1, "only the changed box is published");
+	unsigned nr_changes = 0;
+	bool changes_read = reader.read_changes([&](uint32_t index, const shared_transform& s, uint64_t) {
+		++nr_changes;
+		C.check(index == 1 && s.translation[0] == 7.0f && s.translation[2] == 9.0f, "change carries index and transform");
+	});
+	C.check(changes_read && nr_changes == 1, "reader sees exactly one change");
+
+	// growing creates the next generation, which the open reader follows through the old header
+	publish_round(publisher, 10, 1);
+	C.check(publisher.get_generation() == 1 && publisher.get_capacity() == 20, "segment grows to the next generation");
+	C.check(reader.is_stale(), "old segment is marked stale");
+	C.check(reader.follow() && !reader.is_stale(), "reader follows to the grown segment");
+	C.check(snapshot_matches(reader, 10, 1), "snapshot after growth");
+
+	// readers opening later find the latest generation through generation 0, also after a second growth
+	publish_round(publisher, 50, 2);
+	transform_reader late_reader;
+	C.check(late_reader.open(name), "late reader opens latest generation");
+	C.check(snapshot_matches(late_reader, 50, 2), "late reader snapshot");
+	C.check(reader.is_stale() && reader.follow(), "reader follows second growth");
+	C.check(snapshot_matches(reader, 50, 2), "snapshot after second growth");
+
+	// closing without replacement leaves nothing to follow
+	publisher.close();
+	C.check(reader.is_stale() && !reader.follow(), "reader does not follow a closed publisher");
+
+	std::cout << (C.nr_failures == 0 ? "transform round trip passed" : "transform round trip failed") << std::endl;
+	return C.nr_failures == 0 ? 0 : 1;
+}
+
+///@}
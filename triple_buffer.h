@@ -0,0 +1,82 @@
+#pragma once
+
+#include <atomic>
+#include <vector>
+#include <cstdint>
+
+///@ingroup NI
+///@{
+
+/**@file
+   lock-free triple buffer to hand over consistent snapshots from a single writer to a single reader
+*/
+
+/// the writer fills the back buffer and publishes it, the reader latches the most recent published buffer as front; neither side ever waits
+template <typename T>
+class triple_buffer
+{
+protected:
+	// flag stored together with the index of the middle buffer that marks it as not yet consumed by the reader
+	static const unsigned fresh_bit = 4;
+	// storage of back, middle and front buffer
+	T buffers[3];
+	// index of the buffer exchanged between writer and reader
+	std::atomic<unsigned> middle;
+	// index of buffer owned by the writer
+	unsigned back;
+	// index of buffer owned by the reader
+	unsigned front;
+public:
+	/// construct with default constructed buffers
+	triple_buffer() : middle(1), back(0), front(2) {}
+	/// writer side: access buffer to be filled
+	T& ref_back() { return buffers[back]; }
+	/// writer side: return index of the buffer to be filled
+	unsigned get_back_index() const { return back; }
+	/// writer side: publish the back buffer and continue writing to the previous middle buffer
+	void publish() { back = middle.exchange(back | fresh_bit, std::memory_order_acq_rel) & 3; }
+	/// reader side: latch the most recently published buffer and return whether it changed since the last call
+	bool update()
+	{
+		if ((middle.load(std::memory_order_relaxed) & fresh_bit) == 0)
+			return false;
+		front = middle.exchange(front, std::memory_order_acq_rel) & 3;
+		return true;
+	}
+	/// reader side: access the latched buffer
+	const T& ref_front() const { return buffers[front]; }
+};
+
+/// writer side bookkeeping of changed array elements for each of the three buffers, such that a buffer that is filled again only receives the elements changed since it was filled last
+class triple_buffer_changes
+{
+protected:
+	// indices of changed elements per buffer
+	std::vector<unsigned> changed[3];
+	// bit b is set if the element is listed for buffer b
+	std::vector<uint8_t> listed;
+public:
+	/// mark element i as changed in all buffers
+	void mark(unsigned i)
+	{
+		if (i >= listed.size())
+			listed.resize(i + 1, 0);
+		for (unsigned b = 0; b < 3; ++b)
+			if ((listed[i] & (1 << b)) == 0) {
+				listed[i] |= 1 << b;
+				changed[b].push_back(i);
+			}
+	}
+	/// call copy(i) for each element changed since buffer b was filled last and clear its list
+	template <typename copy_func>
+	void apply(unsigned b, copy_func copy)
+	{
+		for (unsigned i : changed[b]) {
+			listed[i] &= ~(1 << b);
+			copy(i);
+		}
+		changed[b].clear();
+	}
+};
+
+///@}